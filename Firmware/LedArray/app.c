@@ -86,43 +86,6 @@ void core_callback_catastrophic_error_detected(void)
 /************************************************************************/
 /* General used functions                                               */
 /************************************************************************/
-uint16_t get_divider(uint8_t prescaler)
-{
-	switch(prescaler)
-	{
-		case TIMER_PRESCALER_DIV1: return 1;
-		case TIMER_PRESCALER_DIV2: return 2;
-		case TIMER_PRESCALER_DIV4: return 4;
-		case TIMER_PRESCALER_DIV8: return 8;
-		case TIMER_PRESCALER_DIV64: return 64;
-		case TIMER_PRESCALER_DIV256: return 256;
-		case TIMER_PRESCALER_DIV1024: return 1024;
-		default: return 0;
-	}
-}
-
-bool update_reals(float * real_freq, float * real_dcycle, float freq, float dcycle)
-{
-	uint8_t prescaler;
-	uint16_t target_count;
-	
-	if (calculate_timer_16bits(32000000, freq, &prescaler, &target_count))
-	{
-		*real_freq = 32000000.0 / ((uint32_t)(get_divider(prescaler)) * (uint32_t)target_count);
-		*real_dcycle = 100.0 * ((float)((uint16_t)(dcycle/100.0 * target_count + 0.5)) / target_count);
-		//duty_cycle0 = app_regs.REG_CH0_DUTYCYCLE/100.0 * target_count + 0.5;
-		
-		if (*real_dcycle <= 0 || *real_dcycle >= 100)
-			return false;
-	}
-	else
-	{
-		return false;
-	}
-
-	return true;
-}
-
 static const uint8_t crc_table[] = {
 	0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31,
 	0x24, 0x23, 0x2a, 0x2d, 0x70, 0x77, 0x7e, 0x79, 0x6c, 0x6b, 0x62, 0x65,
@@ -230,6 +193,8 @@ void core_callback_reset_registers(void)
 	app_regs.REG_LED0_PWM_FREQ = 5;				// 5 Hz
 	app_regs.REG_LED0_PWM_DCYCLE = 50;			// 50 %
 	app_regs.REG_LED0_PWM_PULSES = 30;			// 3 s
+	app_regs.REG_LED0_PWM_PERIOD = 6400000;		// 5 Hz
+	app_regs.REG_LED0_PWM_ON = 3200000;			// 50 %
 	app_regs.REG_LED0_INTERVAL_ON = 25;			// 25 ms
 	app_regs.REG_LED0_INTERVAL_OFF = 150;		// 150 ms
 	app_regs.REG_LED0_INTERVAL_PULSES = 10;	// 10 pulses
@@ -240,6 +205,8 @@ void core_callback_reset_registers(void)
 	app_regs.REG_LED1_PWM_FREQ = 5;				// 5 Hz
 	app_regs.REG_LED1_PWM_DCYCLE = 50;			// 50 %
 	app_regs.REG_LED1_PWM_PULSES = 30;			// 3 s
+	app_regs.REG_LED1_PWM_PERIOD = 6400000;		// 5 Hz
+	app_regs.REG_LED1_PWM_ON = 3200000;			// 50 %
 	app_regs.REG_LED1_INTERVAL_ON = 25;			// 25 ms
 	app_regs.REG_LED1_INTERVAL_OFF = 150;		// 150 ms
 	app_regs.REG_LED1_INTERVAL_PULSES = 10;	// 10 pulses
@@ -260,9 +227,133 @@ void core_callback_reset_registers(void)
 	app_regs.REG_DUMMY0 = 0;
 
 	app_regs.REG_EVNT_ENABLE = B_EVT_IN_STATE | B_EVT_LED_ON;
+	
+	app_regs.REG_LED0_SEGMENTS_INDEX = 0;
+	app_regs.REG_LED1_SEGMENTS_INDEX = 0;
+	
+	app_regs.REG_LED0_CHIRP_FREQ_START = 5;	// 5 Hz
+	app_regs.REG_LED0_CHIRP_FREQ_END = 50;		// 50 Hz
+	app_regs.REG_LED0_CHIRP_PERIODS = 32;		// 32 periods
+	app_regs.REG_LED1_CHIRP_FREQ_START = 5;	// 5 Hz
+	app_regs.REG_LED1_CHIRP_FREQ_END = 50;		// 50 Hz
+	app_regs.REG_LED1_CHIRP_PERIODS = 32;		// 32 periods
+	
+	app_regs.REG_LED0_INTERVAL_ON_US = 500;		// 500 us
+	app_regs.REG_LED0_INTERVAL_OFF_US = 4500;	// 4.5 ms
+	app_regs.REG_LED0_INTERVAL_TAIL_US = 1000000;	// 1 s
+	app_regs.REG_LED1_INTERVAL_ON_US = 500;		// 500 us
+	app_regs.REG_LED1_INTERVAL_OFF_US = 4500;	// 4.5 ms
+	app_regs.REG_LED1_INTERVAL_TAIL_US = 1000000;	// 1 s
+	
+	app_regs.REG_LED0_START_LATENCY = 0;
+	app_regs.REG_LED1_START_LATENCY = 0;
+	
+	app_regs.REG_LED_SYNC_OFFSET = 0;
+	
+	app_regs.REG_LED_SCHEDULE_SECOND = 0;
+	app_regs.REG_LED_SCHEDULE_MICRO = 0;
+	app_regs.REG_LED_SCHEDULE = 0;
+	
+	app_regs.REG_LED0_ENVELOPE_FREQ = 10;
+	app_regs.REG_LED0_ENVELOPE_DEPTH = 100;
+	app_regs.REG_LED0_ENVELOPE_OFFSET = 0;
+	app_regs.REG_LED0_ENVELOPE_CYCLES = 10;
+	app_regs.REG_LED1_ENVELOPE_FREQ = 10;
+	app_regs.REG_LED1_ENVELOPE_DEPTH = 100;
+	app_regs.REG_LED1_ENVELOPE_OFFSET = 0;
+	app_regs.REG_LED1_ENVELOPE_CYCLES = 10;
+	app_regs.REG_LED_ENVELOPE_SHAPE = 0;
+	
+	for (uint8_t i = 0; i < 5; i++)
+	{
+		app_regs.REG_LED0_QUEUE[i] = 0;
+		app_regs.REG_LED1_QUEUE[i] = 0;
+	}
+	app_regs.REG_LED0_QUEUE_COUNT = 0;
+	app_regs.REG_LED1_QUEUE_COUNT = 0;
+	
+	app_regs.REG_LED0_PWM_PULSES_LONG = 30;		// 3 s
+	app_regs.REG_LED0_INTERVAL_REPS_LONG = 3;	// 3 repetitions
+	app_regs.REG_LED1_PWM_PULSES_LONG = 30;		// 3 s
+	app_regs.REG_LED1_INTERVAL_REPS_LONG = 3;	// 3 repetitions
+	
+	app_regs.REG_LED_JITTER = 0;
+	app_regs.REG_LED0_JITTER_MIN_US = 1000;		// 1 ms
+	app_regs.REG_LED0_JITTER_MAX_US = 100000;	// 100 ms
+	app_regs.REG_LED0_JITTER_SEED = 1;
+	app_regs.REG_LED0_JITTER_OFF_US = 0;
+	app_regs.REG_LED1_JITTER_MIN_US = 1000;		// 1 ms
+	app_regs.REG_LED1_JITTER_MAX_US = 100000;	// 100 ms
+	app_regs.REG_LED1_JITTER_SEED = 2;
+	app_regs.REG_LED1_JITTER_OFF_US = 0;
+	
+	app_regs.REG_LED0_PROGRAM_INDEX = 0;
+	app_regs.REG_LED1_PROGRAM_INDEX = 0;
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		app_regs.REG_LED0_PROGRAM[i] = 0;
+		app_regs.REG_LED1_PROGRAM[i] = 0;
+	}
+	app_regs.REG_LED0_PROGRAM_EVENT = 0;
+	app_regs.REG_LED1_PROGRAM_EVENT = 0;
+	
+	app_regs.REG_LED_DEAD_TIME = 320;				// 10 us
+	
+	/* Theta burst: 3 pulses at 50 Hz, 5 bursts per second and 5 trains of 10 bursts every 10 s */
+	uint32_t nest[10] = {5000, 15000, 3, 140000, 10, 8000000, 5, 0, 1, 0};
+	for (uint8_t i = 0; i < 10; i++)
+	{
+		app_regs.REG_LED0_NEST[i] = nest[i];
+		app_regs.REG_LED1_NEST[i] = nest[i];
+	}
+	
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		app_regs.REG_LED0_PROGRESS[i] = 0;
+		app_regs.REG_LED1_PROGRESS[i] = 0;
+	}
+	
+	app_regs.REG_IN_CAPTURE = 0;
+	app_regs.REG_IN_CAPTURE_EDGES = 16;
+	app_regs.REG_IN_CAPTURE_PERIOD = 10;
+	for (uint8_t i = 0; i < 16; i++)
+		app_regs.REG_IN_CAPTURE_EVENT[i] = CAPTURE_UNUSED;
+	
+	app_regs.REG_IN_EVENT_CONF = GM_IN0_EVENT_EDGES | GM_IN1_EVENT_EDGES;
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		app_regs.REG_IN_EVENT_NTH[i] = 10;
+		app_regs.REG_IN_EVENT_PERIOD_US[i] = 1000;
+		app_regs.REG_IN_EDGES[i] = 0;
+		app_regs.REG_IN_FILTER_SAMPLES[i] = 4;			// 125 ns
+		app_regs.REG_IN_HOLDOFF_MS[i] = 0;
+	}
+	
+	app_regs.REG_IN_MEASURE = 0;
+	app_regs.REG_IN_MEASURE_WINDOW_MS = 1000;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		app_regs.REG_IN0_MEASURE[i] = 0;
+		app_regs.REG_IN1_MEASURE[i] = 0;
+	}
+	
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		app_regs.REG_LED0_SEGMENTS[i] = 0;
+		app_regs.REG_LED1_SEGMENTS[i] = 0;
+	}
 }
 
 bool bus_expansion_exists;
+void pwm_arm_leds(void);
+void schedule_new_second(void);
+void inputs_configure(void);
+void inputs_arm(void);
+void capture_timeout(void);
+void input_events_timeout(void);
+void input_events_reset(void);
+void input_holdoff_timeout(void);
+void measure_timeout(void);
 
 void core_callback_registers_were_reinitialized(void)
 {  
@@ -375,8 +466,10 @@ void core_callback_registers_were_reinitialized(void)
       if (read_LED1_TRANSISTOR)
          set_OUT1; else clr_OUT1;
    
-   update_reals(&app_regs.REG_LED0_PWM_FREQ_REAL, &app_regs.REG_LED0_PWM_DCYCLE_REAL, app_regs.REG_LED0_PWM_FREQ, app_regs.REG_LED0_PWM_DCYCLE);
-   update_reals(&app_regs.REG_LED1_PWM_FREQ_REAL, &app_regs.REG_LED1_PWM_DCYCLE_REAL, app_regs.REG_LED1_PWM_FREQ, app_regs.REG_LED1_PWM_DCYCLE);
+   pwm_arm_leds();
+   
+   inputs_configure();
+   input_events_reset();
 }
 
 /************************************************************************/
@@ -414,10 +507,19 @@ uint16_t SMBus_exist_on_bus1_counter = 1500;
 
 void core_callback_t_before_exec(void) {}
 void core_callback_t_after_exec(void) {}
-void core_callback_t_new_second(void) {}
+void core_callback_t_new_second(void)
+{
+	schedule_new_second();
+}
 void core_callback_t_500us(void) {}
 void core_callback_t_1ms(void)
 {
+   inputs_arm();
+   capture_timeout();
+   input_events_timeout();
+   input_holdoff_timeout();
+   measure_timeout();
+   
    if (SMBus_exist_on_bus0 == false)
    {
       if (++SMBus_exist_on_bus0_counter == 3000)
@@ -4,6 +4,8 @@
 
 #include "fly_pit_boxes.h"
 
+#include <avr/pgmspace.h>
+
 /************************************************************************/
 /* Create pointers to functions                                         */
 /************************************************************************/
@@ -43,7 +45,84 @@ void (*app_func_rd_pointer[])(void) = {
 	&app_read_REG_AUX_SUPPLY_PWR_CONF,
 	&app_read_REG_OUT_STATE,
 	&app_read_REG_DUMMY0,
-	&app_read_REG_EVNT_ENABLE
+	&app_read_REG_EVNT_ENABLE,
+	&app_read_REG_LED0_SEGMENTS_INDEX,
+	&app_read_REG_LED0_SEGMENTS,
+	&app_read_REG_LED1_SEGMENTS_INDEX,
+	&app_read_REG_LED1_SEGMENTS,
+	&app_read_REG_LED0_CHIRP_FREQ_START,
+	&app_read_REG_LED0_CHIRP_FREQ_END,
+	&app_read_REG_LED0_CHIRP_PERIODS,
+	&app_read_REG_LED1_CHIRP_FREQ_START,
+	&app_read_REG_LED1_CHIRP_FREQ_END,
+	&app_read_REG_LED1_CHIRP_PERIODS,
+	&app_read_REG_LED0_INTERVAL_ON_US,
+	&app_read_REG_LED0_INTERVAL_OFF_US,
+	&app_read_REG_LED0_INTERVAL_TAIL_US,
+	&app_read_REG_LED1_INTERVAL_ON_US,
+	&app_read_REG_LED1_INTERVAL_OFF_US,
+	&app_read_REG_LED1_INTERVAL_TAIL_US,
+	&app_read_REG_LED0_START_LATENCY,
+	&app_read_REG_LED1_START_LATENCY,
+	&app_read_REG_LED_SYNC_OFFSET,
+	&app_read_REG_LED_SCHEDULE_SECOND,
+	&app_read_REG_LED_SCHEDULE_MICRO,
+	&app_read_REG_LED_SCHEDULE,
+	&app_read_REG_LED0_ENVELOPE_FREQ,
+	&app_read_REG_LED0_ENVELOPE_DEPTH,
+	&app_read_REG_LED0_ENVELOPE_OFFSET,
+	&app_read_REG_LED0_ENVELOPE_CYCLES,
+	&app_read_REG_LED1_ENVELOPE_FREQ,
+	&app_read_REG_LED1_ENVELOPE_DEPTH,
+	&app_read_REG_LED1_ENVELOPE_OFFSET,
+	&app_read_REG_LED1_ENVELOPE_CYCLES,
+	&app_read_REG_LED_ENVELOPE_SHAPE,
+	&app_read_REG_LED0_PWM_PERIOD,
+	&app_read_REG_LED0_PWM_ON,
+	&app_read_REG_LED1_PWM_PERIOD,
+	&app_read_REG_LED1_PWM_ON,
+	&app_read_REG_LED0_QUEUE,
+	&app_read_REG_LED0_QUEUE_COUNT,
+	&app_read_REG_LED1_QUEUE,
+	&app_read_REG_LED1_QUEUE_COUNT,
+	&app_read_REG_LED0_PWM_PULSES_LONG,
+	&app_read_REG_LED0_INTERVAL_REPS_LONG,
+	&app_read_REG_LED1_PWM_PULSES_LONG,
+	&app_read_REG_LED1_INTERVAL_REPS_LONG,
+	&app_read_REG_LED_JITTER,
+	&app_read_REG_LED0_JITTER_MIN_US,
+	&app_read_REG_LED0_JITTER_MAX_US,
+	&app_read_REG_LED0_JITTER_SEED,
+	&app_read_REG_LED0_JITTER_OFF_US,
+	&app_read_REG_LED1_JITTER_MIN_US,
+	&app_read_REG_LED1_JITTER_MAX_US,
+	&app_read_REG_LED1_JITTER_SEED,
+	&app_read_REG_LED1_JITTER_OFF_US,
+	&app_read_REG_LED0_PROGRAM_INDEX,
+	&app_read_REG_LED0_PROGRAM,
+	&app_read_REG_LED0_PROGRAM_EVENT,
+	&app_read_REG_LED1_PROGRAM_INDEX,
+	&app_read_REG_LED1_PROGRAM,
+	&app_read_REG_LED1_PROGRAM_EVENT,
+	&app_read_REG_LED_DEAD_TIME,
+	&app_read_REG_LED0_NEST,
+	&app_read_REG_LED1_NEST,
+	&app_read_REG_LED0_PROGRESS,
+	&app_read_REG_LED1_PROGRESS,
+	&app_read_REG_IN_CAPTURE,
+	&app_read_REG_IN_CAPTURE_EDGES,
+	&app_read_REG_IN_CAPTURE_PERIOD,
+	&app_read_REG_IN_CAPTURE_EVENT,
+	&app_read_REG_IN_EVENT_CONF,
+	&app_read_REG_IN_EVENT_NTH,
+	&app_read_REG_IN_EVENT_PERIOD_US,
+	&app_read_REG_IN_EDGES,
+	&app_read_REG_IN_FILTER_SAMPLES,
+	&app_read_REG_IN_HOLDOFF_MS,
+	&app_read_REG_IN_MEASURE,
+	&app_read_REG_IN_MEASURE_WINDOW_MS,
+	&app_read_REG_IN0_MEASURE,
+	&app_read_REG_IN1_MEASURE
 };
 
 bool (*app_func_wr_pointer[])(void*) = {
@@ -80,7 +159,84 @@ bool (*app_func_wr_pointer[])(void*) = {
 	&app_write_REG_AUX_SUPPLY_PWR_CONF,
 	&app_write_REG_OUT_STATE,
 	&app_write_REG_DUMMY0,
-	&app_write_REG_EVNT_ENABLE
+	&app_write_REG_EVNT_ENABLE,
+	&app_write_REG_LED0_SEGMENTS_INDEX,
+	&app_write_REG_LED0_SEGMENTS,
+	&app_write_REG_LED1_SEGMENTS_INDEX,
+	&app_write_REG_LED1_SEGMENTS,
+	&app_write_REG_LED0_CHIRP_FREQ_START,
+	&app_write_REG_LED0_CHIRP_FREQ_END,
+	&app_write_REG_LED0_CHIRP_PERIODS,
+	&app_write_REG_LED1_CHIRP_FREQ_START,
+	&app_write_REG_LED1_CHIRP_FREQ_END,
+	&app_write_REG_LED1_CHIRP_PERIODS,
+	&app_write_REG_LED0_INTERVAL_ON_US,
+	&app_write_REG_LED0_INTERVAL_OFF_US,
+	&app_write_REG_LED0_INTERVAL_TAIL_US,
+	&app_write_REG_LED1_INTERVAL_ON_US,
+	&app_write_REG_LED1_INTERVAL_OFF_US,
+	&app_write_REG_LED1_INTERVAL_TAIL_US,
+	&app_write_REG_LED0_START_LATENCY,
+	&app_write_REG_LED1_START_LATENCY,
+	&app_write_REG_LED_SYNC_OFFSET,
+	&app_write_REG_LED_SCHEDULE_SECOND,
+	&app_write_REG_LED_SCHEDULE_MICRO,
+	&app_write_REG_LED_SCHEDULE,
+	&app_write_REG_LED0_ENVELOPE_FREQ,
+	&app_write_REG_LED0_ENVELOPE_DEPTH,
+	&app_write_REG_LED0_ENVELOPE_OFFSET,
+	&app_write_REG_LED0_ENVELOPE_CYCLES,
+	&app_write_REG_LED1_ENVELOPE_FREQ,
+	&app_write_REG_LED1_ENVELOPE_DEPTH,
+	&app_write_REG_LED1_ENVELOPE_OFFSET,
+	&app_write_REG_LED1_ENVELOPE_CYCLES,
+	&app_write_REG_LED_ENVELOPE_SHAPE,
+	&app_write_REG_LED0_PWM_PERIOD,
+	&app_write_REG_LED0_PWM_ON,
+	&app_write_REG_LED1_PWM_PERIOD,
+	&app_write_REG_LED1_PWM_ON,
+	&app_write_REG_LED0_QUEUE,
+	&app_write_REG_LED0_QUEUE_COUNT,
+	&app_write_REG_LED1_QUEUE,
+	&app_write_REG_LED1_QUEUE_COUNT,
+	&app_write_REG_LED0_PWM_PULSES_LONG,
+	&app_write_REG_LED0_INTERVAL_REPS_LONG,
+	&app_write_REG_LED1_PWM_PULSES_LONG,
+	&app_write_REG_LED1_INTERVAL_REPS_LONG,
+	&app_write_REG_LED_JITTER,
+	&app_write_REG_LED0_JITTER_MIN_US,
+	&app_write_REG_LED0_JITTER_MAX_US,
+	&app_write_REG_LED0_JITTER_SEED,
+	&app_write_REG_LED0_JITTER_OFF_US,
+	&app_write_REG_LED1_JITTER_MIN_US,
+	&app_write_REG_LED1_JITTER_MAX_US,
+	&app_write_REG_LED1_JITTER_SEED,
+	&app_write_REG_LED1_JITTER_OFF_US,
+	&app_write_REG_LED0_PROGRAM_INDEX,
+	&app_write_REG_LED0_PROGRAM,
+	&app_write_REG_LED0_PROGRAM_EVENT,
+	&app_write_REG_LED1_PROGRAM_INDEX,
+	&app_write_REG_LED1_PROGRAM,
+	&app_write_REG_LED1_PROGRAM_EVENT,
+	&app_write_REG_LED_DEAD_TIME,
+	&app_write_REG_LED0_NEST,
+	&app_write_REG_LED1_NEST,
+	&app_write_REG_LED0_PROGRESS,
+	&app_write_REG_LED1_PROGRESS,
+	&app_write_REG_IN_CAPTURE,
+	&app_write_REG_IN_CAPTURE_EDGES,
+	&app_write_REG_IN_CAPTURE_PERIOD,
+	&app_write_REG_IN_CAPTURE_EVENT,
+	&app_write_REG_IN_EVENT_CONF,
+	&app_write_REG_IN_EVENT_NTH,
+	&app_write_REG_IN_EVENT_PERIOD_US,
+	&app_write_REG_IN_EDGES,
+	&app_write_REG_IN_FILTER_SAMPLES,
+	&app_write_REG_IN_HOLDOFF_MS,
+	&app_write_REG_IN_MEASURE,
+	&app_write_REG_IN_MEASURE_WINDOW_MS,
+	&app_write_REG_IN0_MEASURE,
+	&app_write_REG_IN1_MEASURE
 };
 
 
@@ -97,1165 +253,5877 @@ uint8_t led0_mode, led1_mode;
 #define MODE_LED1_PWM 0
 #define MODE_LED0_INTERVAL 1
 #define MODE_LED1_INTERVAL 1
+#define MODE_LED0_PWM_HW 2
+#define MODE_LED1_PWM_HW 2
+#define MODE_LED0_SEGMENTS 3
+#define MODE_LED1_SEGMENTS 3
+#define MODE_LED0_CHIRP 4
+#define MODE_LED1_CHIRP 4
+#define MODE_LED0_ENVELOPE 6
+#define MODE_LED1_ENVELOPE 6
+#define MODE_LED0_BURST 7
+#define MODE_LED1_BURST 7
+#define MODE_LED0_PROGRAM 8
+#define MODE_LED1_PROGRAM 8
+#define MODE_LED0_COMPLEMENTARY 9
+#define MODE_LED1_COMPLEMENTARY 9
+
+/* Event channels used to count the LEDs' pulses */
+#define EVCH_LED0_PULSES EVSYS_CH1MUX
+#define EVCH_LED1_PULSES EVSYS_CH6MUX
+
+/* The auxiliary timers of stopped LEDs time the start latency in 32 MHz cycles */
+#define START_LED0_STOPWATCH if (!TCC0_CTRLA) {TCE0.CTRLA = TC_CLKSEL_OFF_gc; TCE0.CTRLFSET = TC_CMD_RESET_gc; TCE0.CTRLA = TC_CLKSEL_DIV1_gc;}
+#define START_LED1_STOPWATCH if (!TCD0_CTRLA) {TCD1.CTRLA = TC_CLKSEL_OFF_gc; TCD1.CTRLFSET = TC_CMD_RESET_gc; TCD1.CTRLA = TC_CLKSEL_DIV1_gc;}
 
 typedef struct
 {
-   uint16_t pulses;
+   uint8_t prescaler;               // Armed when the frequency or duty cycle are written
+   uint16_t per, cca;
+   uint16_t divider;
+   uint16_t remainder;              // Cycles of the period left out of PER
+   uint16_t per_nearest;            // PER rounded to the nearest tick, for the periods that aren't dithered
+   uint16_t dither;                 // Remainders accumulated by the dithering
+   uint32_t period, on;             // Cycles generated, in average
+   uint16_t pulses;                 // Low word of the pulses left
+   uint16_t pulses_high;            // Only touched when the low word runs out
+   uint32_t count;                  // Pulses of the running protocol
+   bool forever;                    // Runs until stopped
 } pwm_t;
 
+#define NEST_LEVELS 4
+
 typedef struct
 {
-   uint16_t on_ms, off_ms;
-   uint16_t pulses;
-   uint16_t tail_ms;
-   uint16_t reps;
+   uint32_t on_us, off_us;          // Configuration latched at start
+   uint8_t levels;                  // Groups nested around the pulses
+   uint32_t count[NEST_LEVELS];     // Units of the level below, or pulses on level 0
+   uint32_t gap_us[NEST_LEVELS];    // Appended to the last OFF time of each group
+   uint32_t durations;              // All the above ORed, for the timebase
+   uint8_t prescaler, shift;        // Timebase of the durations
+   uint32_t on_ticks, off_ticks;    // Ticks left on the current pulse
+   uint32_t left[NEST_LEVELS];      // Units left to start on each level
+   bool forever;                    // The outermost level repeats until stopped
+   uint32_t repeated;               // Outermost units started when repeating until stopped
+   bool last_period;                // No more periods after the running one
+   uint8_t jitter;                  // Distribution of the OFF times
+   uint32_t random;                 // Xorshift state
+   uint32_t jitter_min, jitter_max; // Ticks
+   uint32_t jitter_span;            // Ticks scaled by the distribution
 } interval_t;
 
+#define SEGMENTS_MAX 32
+#define SEGMENTS_CHUNK 8
+
+typedef struct
+{
+   uint32_t entries[SEGMENTS_MAX];  // Table uploaded through REG_LEDx_SEGMENTS
+   uint8_t length;
+   uint8_t index;                   // Next segment to load
+   uint8_t shift;                   // Timebase of the durations
+   uint32_t ticks;                  // Ticks left on the loaded segment
+   uint32_t loaded, running;        // Flags of the buffered and of the running periods
+   bool last_period;                // No more periods after the running one
+} segments_t;
+
+#define PROGRAM_MAX 32
+#define PROGRAM_CHUNK 8
+#define PROGRAM_LOOPS 4
+
+typedef struct
+{
+   uint32_t code[PROGRAM_MAX];      // Program uploaded through REG_LEDx_PROGRAM
+   uint8_t length;
+   uint8_t pc;                      // Next instruction
+   uint8_t shift;                   // Timebase of the waits
+   uint32_t ticks;                  // Ticks left on the loaded wait
+   uint8_t loaded, running;         // Outputs of the buffered and of the running periods
+   uint32_t event;                  // Emitted when the loaded period runs
+   uint8_t depth;
+   uint8_t loop_pc[PROGRAM_LOOPS];
+   uint32_t loop_count[PROGRAM_LOOPS];
+   bool last_period;                // No more periods after the running one
+} program_t;
+
+#define CHIRP_MAX 32
+
+typedef struct
+{
+   uint16_t per, cca;               // Same layout of PERBUF and CCABUF
+} chirp_period_t;
+
+typedef struct
+{
+   chirp_period_t periods[CHIRP_MAX];
+} chirp_t;
+
+typedef struct
+{
+   uint32_t phase, step;            // Position on the envelope (a full turn is 2^32)
+   uint16_t offset, depth;          // Ticks of the carrier period
+   uint16_t cycles;                 // Envelope cycles left
+   bool ramp;
+} envelope_t;
+
+#define QUEUE_DEPTH 4
+
+typedef struct
+{
+   uint8_t mode;                    // MODE_LEDx_PWM or MODE_LEDx_INTERVAL
+   uint32_t a, b;                   // Period and ON cycles, or ON and OFF microseconds
+   uint32_t tail_us;
+   uint16_t pulses, reps;
+} protocol_t;
+
+typedef struct
+{
+   protocol_t entries[QUEUE_DEPTH];
+   volatile uint8_t head, tail;     // Free running, the ISR only moves the head
+   uint8_t mode, prescaler;         // Protocol buffered for the next overflow
+   bool handover;
+   bool rearm;                      // The armed PWM was replaced by a queued one
+} queue_t;
+
 typedef struct
 {
    pwm_t pwm;
    interval_t interval;
+   segments_t segments;
+   program_t program;
+   chirp_t chirp;
+   envelope_t envelope;
+   queue_t queue;
 } behaviour_t;
 
 behaviour_t led0, led1;
 
-void start_led0_pwm(void)
+/************************************************************************/
+/* Channels                                                             */
+/*                                                                      */
+/* Everything that tells LED0 from LED1 is in the descriptors below, so */
+/* the engines are compiled once. The table lives in flash. The helpers */
+/* used by the timer interrupts are always inlined, so each ISR folds   */
+/* its constant descriptor instead of reading it at run time.           */
+/************************************************************************/
+typedef struct
 {
-   uint8_t prescaler;
-   uint16_t target_count, duty_cycle;
-   
-   if (calculate_timer_16bits(32000000, app_regs.REG_LED0_PWM_FREQ, &prescaler, &target_count))
+   TC0_t * timer;
+   TC0_t * aux;                     // TCE0, or TCD1 that shares its layout
+   bool aux_type1;
+   register8_t * pulses_evch;       // Clocks the auxiliary timer with the compares
+   uint8_t pulses_source, pulses_clock;
+   DMA_CH_t * dma;
+   uint8_t dma_trigger;             // The timer's overflow
+   behaviour_t * led;
+   uint8_t * mode;
+   PORT_t * transistor_port;
+   PORT_t * board_port;
+   PORT_t * power_port;
+   PORT_t * out_port;
+   uint8_t transistor, board, power, out;        // Pin masks
+   uint8_t out_conf;                // MSK_OUTx_CONF
+   uint8_t out_led_on, out_led_start, out_software, out_pwr_en;
+   uint8_t start, other_start;      // Bits of REG_LED_BEHAVING
+   uint8_t to_on, other_to_on;      // Bits of REG_LED_ON
+   uint8_t jitter_conf, jitter_shift;
+   uint16_t * latency;
+   uint32_t * pwm_period;
+   uint32_t * pwm_on;
+   uint32_t * pwm_pulses;
+   uint32_t * jitter_min;
+   uint32_t * jitter_max;
+   uint32_t * jitter_seed;
+   uint32_t * program_event;
+   uint8_t program_event_add;
+   uint32_t * nest;
+} channel_t;
+
+const __flash channel_t channels[] = {
    {
-      clr_LED0_TRANSISTOR;
-      
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
-         clr_OUT0;
-      
-      duty_cycle = app_regs.REG_LED0_PWM_DCYCLE/100.0 * target_count + 0.5;
-      timer_type0_pwm(&TCC0, prescaler, target_count, duty_cycle, INT_LEVEL_LOW, INT_LEVEL_LOW);
-      
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_START)
-         set_OUT0;
-
-      app_regs.REG_LED_BEHAVING = (app_regs.REG_LED_BEHAVING & B_LED1_START) | B_LED0_START;
-      app_regs.REG_LED_ON = (app_regs.REG_LED_ON & B_LED1_TO_ON) | B_LED0_TO_ON;
-      
-      UPDATE_BOARD_LED0;
-      
-      led0_mode = MODE_LED0_PWM;
-      led0.pwm.pulses = app_regs.REG_LED0_PWM_PULSES;
+      &TCC0, &TCE0, false, &EVCH_LED0_PULSES, EVSYS_CHMUX_TCC0_CCA_gc, TC_CLKSEL_EVCH1_gc,
+      &DMA.CH0, DMA_CH_TRIGSRC_TCC0_OVF_gc, &led0, &led0_mode,
+      &PORTC, &PORTC, &PORTC, &PORTD, 1 << 0, 1 << 4, 1 << 5, 1 << 7,
+      MSK_OUT0_CONF, GM_OUT0_LED0_ON, GM_OUT0_LED0_START, GM_OUT0_SOFTWARE, GM_OUT0_LED0_PWR_EN,
+      B_LED0_START, B_LED1_START, B_LED0_TO_ON, B_LED1_TO_ON, MSK_LED0_JITTER, 0,
+      &app_regs.REG_LED0_START_LATENCY,
+      &app_regs.REG_LED0_PWM_PERIOD, &app_regs.REG_LED0_PWM_ON, &app_regs.REG_LED0_PWM_PULSES_LONG,
+      &app_regs.REG_LED0_JITTER_MIN_US, &app_regs.REG_LED0_JITTER_MAX_US, &app_regs.REG_LED0_JITTER_SEED,
+      &app_regs.REG_LED0_PROGRAM_EVENT, ADD_REG_LED0_PROGRAM_EVENT,
+      app_regs.REG_LED0_NEST
+   },
+   {
+      &TCD0, (TC0_t*)&TCD1, true, &EVCH_LED1_PULSES, EVSYS_CHMUX_TCD0_CCA_gc, TC_CLKSEL_EVCH6_gc,
+      &DMA.CH1, DMA_CH_TRIGSRC_TCD0_OVF_gc, &led1, &led1_mode,
+      &PORTD, &PORTC, &PORTC, &PORTA, 1 << 0, 1 << 1, 1 << 6, 1 << 2,
+      MSK_OUT1_CONF, GM_OUT1_LED1_ON, GM_OUT1_LED1_START, GM_OUT1_SOFTWARE, GM_OUT1_LED1_PWR_EN,
+      B_LED1_START, B_LED0_START, B_LED1_TO_ON, B_LED0_TO_ON, MSK_LED1_JITTER, 4,
+      &app_regs.REG_LED1_START_LATENCY,
+      &app_regs.REG_LED1_PWM_PERIOD, &app_regs.REG_LED1_PWM_ON, &app_regs.REG_LED1_PWM_PULSES_LONG,
+      &app_regs.REG_LED1_JITTER_MIN_US, &app_regs.REG_LED1_JITTER_MAX_US, &app_regs.REG_LED1_JITTER_SEED,
+      &app_regs.REG_LED1_PROGRAM_EVENT, ADD_REG_LED1_PROGRAM_EVENT,
+      app_regs.REG_LED1_NEST
    }
-}
+};
 
-void start_led1_pwm(void)
+/* Same as UPDATE_BOARD_LEDx */
+static inline __attribute__((always_inline)) void channel_board(const __flash channel_t * ch)
 {
-   uint8_t prescaler;
-   uint16_t target_count, duty_cycle;
-   
-   if (calculate_timer_16bits(32000000, app_regs.REG_LED1_PWM_FREQ, &prescaler, &target_count))
+   if ((ch->power_port->IN & ch->power) && (ch->transistor_port->IN & ch->transistor))
    {
-      clr_LED1_TRANSISTOR;
-      
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
-         clr_OUT1;
-      
-      duty_cycle = app_regs.REG_LED1_PWM_DCYCLE/100.0 * target_count + 0.5;
-      timer_type0_pwm(&TCD0, prescaler, target_count, duty_cycle, INT_LEVEL_LOW, INT_LEVEL_LOW);
-      
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_START)
-         set_OUT1;
-      
-      app_regs.REG_LED_BEHAVING = (app_regs.REG_LED_BEHAVING & B_LED0_START) | B_LED1_START;
-      app_regs.REG_LED_ON = (app_regs.REG_LED_ON & B_LED0_TO_ON) | B_LED1_TO_ON;
-      
-      UPDATE_BOARD_LED1;
-      
-      led1_mode = MODE_LED1_PWM;
-      led1.pwm.pulses = app_regs.REG_LED1_PWM_PULSES;
+      if (core_bool_is_visual_enabled())
+         ch->board_port->OUTSET = ch->board;
+   }
+   else
+   {
+      ch->board_port->OUTCLR = ch->board;
    }
 }
 
-void start_led0_interval(void)
+/* Drives OUTx if it is configured as conf */
+static inline __attribute__((always_inline)) void channel_out(const __flash channel_t * ch, uint8_t conf, bool level)
 {
-   led0_mode = MODE_LED0_INTERVAL;
-   led0.interval.on_ms = app_regs.REG_LED0_INTERVAL_ON;
-   led0.interval.off_ms = app_regs.REG_LED0_INTERVAL_OFF;
-   led0.interval.tail_ms = app_regs.REG_LED0_INTERVAL_TAIL;
-   led0.interval.pulses = app_regs.REG_LED0_INTERVAL_PULSES;
-   led0.interval.reps = app_regs.REG_LED0_INTERVAL_REPS;
-
-   timer_type0_enable(&TCC0, TIMER_PRESCALER_DIV256, 125, INT_LEVEL_LOW); // 1ms
-   
-   set_LED0_TRANSISTOR;
-   
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
-      set_OUT0;
-   
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_START)
-      set_OUT0;
+   if ((app_regs.REG_OUT_CONFIGURATION & ch->out_conf) != conf)
+      return;
    
-   app_regs.REG_LED_BEHAVING = (app_regs.REG_LED_BEHAVING & B_LED1_START) | B_LED0_START;
-   app_regs.REG_LED_ON = (app_regs.REG_LED_ON & B_LED1_TO_ON) | B_LED0_TO_ON;
+   if (level)
+      ch->out_port->OUTSET = ch->out;
+   else
+      ch->out_port->OUTCLR = ch->out;
+}
 
-   UPDATE_BOARD_LED0;
+static inline __attribute__((always_inline)) void channel_led_on(const __flash channel_t * ch, bool on)
+{
+   app_regs.REG_LED_ON = (app_regs.REG_LED_ON & ch->other_to_on) | (on ? ch->to_on : 0);
 }
 
-void start_led1_interval(void)
+static inline __attribute__((always_inline)) void channel_behaving(const __flash channel_t * ch, bool start)
 {
-   led1_mode = MODE_LED1_INTERVAL;
-   led1.interval.on_ms = app_regs.REG_LED1_INTERVAL_ON;
-   led1.interval.off_ms = app_regs.REG_LED1_INTERVAL_OFF;
-   led1.interval.tail_ms = app_regs.REG_LED1_INTERVAL_TAIL;
-   led1.interval.pulses = app_regs.REG_LED1_INTERVAL_PULSES;
-   led1.interval.reps = app_regs.REG_LED1_INTERVAL_REPS;
+   app_regs.REG_LED_BEHAVING = (app_regs.REG_LED_BEHAVING & ch->other_start) | (start ? ch->start : 0);
+}
 
-   timer_type0_enable(&TCD0, TIMER_PRESCALER_DIV256, 125, INT_LEVEL_LOW); // 1ms   
-   
-   set_LED1_TRANSISTOR;
-   
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
-      set_OUT1;
+/* What a start shows in the registers and on the pins */
+typedef struct
+{
+   bool behaving, led_on;
+   bool out, board;
+} channel_shown_t;
+
+void channel_save(const __flash channel_t * ch, channel_shown_t * shown)
+{
+   shown->behaving = app_regs.REG_LED_BEHAVING & ch->start;
+   shown->led_on = app_regs.REG_LED_ON & ch->to_on;
+   shown->out = ch->out_port->OUT & ch->out;
+   shown->board = ch->board_port->OUT & ch->board;
+}
+
+/* Only touches this channel's bits, the other LED may have changed its own */
+void channel_show(const __flash channel_t * ch, const channel_shown_t * shown)
+{
+   channel_behaving(ch, shown->behaving);
+   channel_led_on(ch, shown->led_on);
    
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_START)
-      set_OUT1;
+   if (shown->out)
+      ch->out_port->OUTSET = ch->out;
+   else
+      ch->out_port->OUTCLR = ch->out;
    
-   app_regs.REG_LED_BEHAVING = (app_regs.REG_LED_BEHAVING & B_LED0_START) | B_LED1_START;
-   app_regs.REG_LED_ON = (app_regs.REG_LED_ON & B_LED0_TO_ON) | B_LED1_TO_ON;
-      
-   UPDATE_BOARD_LED1;
+   if (shown->board)
+      ch->board_port->OUTSET = ch->board;
+   else
+      ch->board_port->OUTCLR = ch->board;
 }
 
-/* LED0 Duty Cycle */
-ISR(TCC0_CCA_vect, ISR_NAKED)
+static inline __attribute__((always_inline)) void channel_aux_stop(const __flash channel_t * ch)
 {
-   if (led0_mode == MODE_LED0_PWM)
-   {
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
-         clr_OUT0;
-      
-      app_regs.REG_LED_ON = app_regs.REG_LED_ON & B_LED1_TO_ON;
+   if (ch->aux_type1)
+      timer_type1_stop((TC1_t*)ch->aux);
+   else
+      timer_type0_stop(ch->aux);
+}
 
-      if (--led0.pwm.pulses == 0)
-      {
-         app_regs.REG_LED_BEHAVING = app_regs.REG_LED_BEHAVING & B_LED1_START;
-         
-         timer_type0_stop(&TCC0);
-         
-         if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_START)
-            clr_OUT0;
-      }
-   }
-   
-   UPDATE_BOARD_LED0;
+extern uint8_t * input_hold;
 
-   reti();
+/* Reads the start latency if the auxiliary timer is still the stopwatch */
+void channel_stopwatch(const __flash channel_t * ch)
+{
+   /* A start armed by an input isn't started by a command */
+   if (input_hold || ch->aux->CTRLA != TC_CLKSEL_DIV1_gc)
+      return;
+   
+   *ch->latency = (ch->aux->INTFLAGS & TC0_OVFIF_bm) ? 0xFFFF : ch->aux->CNT;
+   channel_aux_stop(ch);
 }
 
-/* LED1 Duty Cycle */
-ISR(TCD0_CCA_vect, ISR_NAKED)
+/* The auxiliary timer counts the compares and overflows after count of them */
+void channel_count(const __flash channel_t * ch, uint16_t count)
 {
-   if (led1_mode == MODE_LED1_PWM)
-   {
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
-         clr_OUT1;
-         
-      app_regs.REG_LED_ON = app_regs.REG_LED_ON & B_LED0_TO_ON;
-
-      if (--led1.pwm.pulses == 0)
-      {
-         app_regs.REG_LED_BEHAVING = app_regs.REG_LED_BEHAVING & B_LED0_START;
+   /* It is the stopwatch until it starts counting */
+   channel_stopwatch(ch);
+   channel_aux_stop(ch);
+   
+   *ch->pulses_evch = ch->pulses_source;
+   ch->aux->CTRLFSET = TC_CMD_RESET_gc;
+   ch->aux->PER = count - 1;
+   ch->aux->INTCTRLA = INT_LEVEL_LOW;
+   ch->aux->CTRLA = ch->pulses_clock;
+}
 
-         timer_type0_stop(&TCD0);
-         
-         if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_START)
-            clr_OUT1;
-      }
-   }
+/* Only the OUTx mirror still needs the timer interrupts of the hardware generated modes */
+uint8_t channel_mirror(const __flash channel_t * ch)
+{
+   if ((app_regs.REG_OUT_CONFIGURATION & ch->out_conf) != ch->out_led_on)
+      return INT_LEVEL_OFF;
    
-   UPDATE_BOARD_LED1;
+   ch->out_port->OUTCLR = ch->out;
+   return INT_LEVEL_LOW;
+}
 
-   reti();
+/* The board's LED is kept on while the modes too fast to be mirrored run */
+void channel_board_running(const __flash channel_t * ch)
+{
+   if ((ch->power_port->IN & ch->power) && core_bool_is_visual_enabled())
+      ch->board_port->OUTSET = ch->board;
 }
 
+/************************************************************************/
+/* Synchronized start                                                   */
+/*                                                                      */
+/* When both LEDs are started by the same command, their timers are     */
+/* loaded with the clock taken from an event channel that is still off. */
+/* Muxing the prescaler to that channel releases both timers on the     */
+/* same tick, with LED1 delayed by REG_LED_SYNC_OFFSET ticks.           */
+/************************************************************************/
+#define EVCH_SYNC EVSYS_CH5MUX
 
-/* LED0 Overflow */
-ISR(TCC0_OVF_vect, ISR_NAKED)
+bool sync_hold;
+uint8_t sync_prescaler_led0, sync_prescaler_led1;
+uint8_t * input_hold;                  // Takes the prescaler of a start armed by an input
+
+void timer_release(TC0_t * timer, uint8_t prescaler)
 {
-   if (led0_mode == MODE_LED0_PWM)
+   if (input_hold)
    {
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
-         set_OUT0;
-         
-      app_regs.REG_LED_ON = (app_regs.REG_LED_ON & B_LED1_TO_ON) | B_LED0_TO_ON;
+      /* The input's edge writes it to CTRLA */
+      *input_hold = prescaler;
+      timer->CTRLA = TC_CLKSEL_OFF_gc;
+   }
+   else if (sync_hold)
+   {
+      if (timer == &TCC0)
+         sync_prescaler_led0 = prescaler;
+      else
+         sync_prescaler_led1 = prescaler;
       
-      UPDATE_BOARD_LED0;
+      timer->CTRLA = TC_CLKSEL_EVCH5_gc;
    }
-   
-   if (led0_mode == MODE_LED0_INTERVAL)
+   else
    {
-      if (--led0.interval.on_ms == 0)
-      {
-         led0.interval.on_ms++;
-
-         if (led0.interval.off_ms == app_regs.REG_LED0_INTERVAL_OFF)
-         {
-            clr_LED0_TRANSISTOR;
-            
-            if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
-               clr_OUT0;
-               
-            UPDATE_BOARD_LED0;
-            
-            app_regs.REG_LED_ON = app_regs.REG_LED_ON & B_LED1_TO_ON;
-         }
-         
-         if (--led0.interval.off_ms + 1 == 0)
-         {
-            if (--led0.interval.pulses > 0)
-            {
-               set_LED0_TRANSISTOR;
-               
-               if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
-                  set_OUT0;
-               
-               UPDATE_BOARD_LED0;
-               
-               app_regs.REG_LED_ON = (app_regs.REG_LED_ON & B_LED1_TO_ON) | B_LED0_TO_ON;
-
-               led0.interval.on_ms = app_regs.REG_LED0_INTERVAL_ON;
-               led0.interval.off_ms = app_regs.REG_LED0_INTERVAL_OFF;
-            }
-            else
-            {
-               led0.interval.pulses++;
-               led0.interval.off_ms++;
-
-               if (--led0.interval.tail_ms + 1 == 0)
-               {
-                  if (--led0.interval.reps == 0)
-                  {
-                     app_regs.REG_LED_BEHAVING = app_regs.REG_LED_BEHAVING & B_LED1_START;
-                     timer_type0_stop(&TCC0);
-                     
-                     if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_START)
-                        clr_OUT0;
-                     
-                     reti();
-                  }
-
-                  set_LED0_TRANSISTOR;
-                  
-                  if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
-                     set_OUT0;
-               
-                  UPDATE_BOARD_LED0;
-                  
-                  app_regs.REG_LED_ON = (app_regs.REG_LED_ON & B_LED1_TO_ON) | B_LED0_TO_ON;
-
-                  led0.interval.on_ms = app_regs.REG_LED0_INTERVAL_ON;
-                  led0.interval.off_ms = app_regs.REG_LED0_INTERVAL_OFF;
-                  led0.interval.pulses = app_regs.REG_LED0_INTERVAL_PULSES;
-                  led0.interval.tail_ms = app_regs.REG_LED0_INTERVAL_TAIL;
-               }
-            }
-         }
-      }
+      timer->CTRLA = prescaler;
    }
+}
 
-   reti();
+void sync_begin(void)
+{
+   /* Timers still clocked by a previous synchronized start go back to their prescaler */
+   if (TCC0.CTRLA == TC_CLKSEL_EVCH5_gc)
+      TCC0.CTRLA = sync_prescaler_led0;
+   if (TCD0.CTRLA == TC_CLKSEL_EVCH5_gc)
+      TCD0.CTRLA = sync_prescaler_led1;
+   
+   EVCH_SYNC = EVSYS_CHMUX_OFF_gc;
+   sync_hold = true;
 }
 
-/* LED1 Overflow */
-ISR(TCD0_OVF_vect, ISR_NAKED)
+void sync_release(void)
 {
-   if (led1_mode == MODE_LED1_PWM)
+   static const uint8_t prescaler_events[] = {
+      EVSYS_CHMUX_OFF_gc,
+      EVSYS_CHMUX_PRESCALER_1_gc,
+      EVSYS_CHMUX_PRESCALER_2_gc,
+      EVSYS_CHMUX_PRESCALER_4_gc,
+      EVSYS_CHMUX_PRESCALER_8_gc,
+      EVSYS_CHMUX_PRESCALER_64_gc,
+      EVSYS_CHMUX_PRESCALER_256_gc,
+      EVSYS_CHMUX_PRESCALER_1024_gc
+   };
+   
+   sync_hold = false;
+   
+   /* Only one of the LEDs was loaded */
+   if (TCC0.CTRLA != TC_CLKSEL_EVCH5_gc || TCD0.CTRLA != TC_CLKSEL_EVCH5_gc)
    {
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
-         set_OUT1;
-         
-      app_regs.REG_LED_ON = (app_regs.REG_LED_ON & B_LED0_TO_ON) | B_LED1_TO_ON;
+      if (TCC0.CTRLA == TC_CLKSEL_EVCH5_gc)
+         TCC0.CTRLA = sync_prescaler_led0;
+      if (TCD0.CTRLA == TC_CLKSEL_EVCH5_gc)
+         TCD0.CTRLA = sync_prescaler_led1;
+      return;
+   }
+   
+   /* The offset is applied as a shorter first period where no period is buffered */
+   /* It is clamped to the OFF time, so the preload starts above CCA and the      */
+   /* first compare counted is the one of an emitted pulse                        */
+   if ((led1_mode == MODE_LED1_PWM || led1_mode == MODE_LED1_PWM_HW) && app_regs.REG_LED_SYNC_OFFSET && TCD0.CCA < TCD0.PER)
+   {
+      uint16_t offset = app_regs.REG_LED_SYNC_OFFSET;
       
-      UPDATE_BOARD_LED1;
+      if (offset > TCD0.PER - TCD0.CCA)
+         offset = TCD0.PER - TCD0.CCA;
+      
+      TCD0.CNT = TCD0.PER + 1 - offset;
    }
    
-   if (led1_mode == MODE_LED1_INTERVAL)
+   if (sync_prescaler_led0 == sync_prescaler_led1)
    {
-      if (--led1.interval.on_ms == 0)
-      {
-         led1.interval.on_ms++;
-
-         if (led1.interval.off_ms == app_regs.REG_LED1_INTERVAL_OFF)
-         {
-            clr_LED1_TRANSISTOR;
-            
-            if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
-               clr_OUT1;
-               
-            UPDATE_BOARD_LED1;
-            
-            app_regs.REG_LED_ON = app_regs.REG_LED_ON & B_LED0_TO_ON;
-         }
-         
-         if (--led1.interval.off_ms + 1 == 0)
-         {
-            if (--led1.interval.pulses > 0)
-            {
-               set_LED1_TRANSISTOR;
-            
-               if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
-                  set_OUT1;
-               
-               UPDATE_BOARD_LED1;
-               
-               app_regs.REG_LED_ON = (app_regs.REG_LED_ON & B_LED0_TO_ON) | B_LED1_TO_ON;
-
-               led1.interval.on_ms = app_regs.REG_LED1_INTERVAL_ON;
-               led1.interval.off_ms = app_regs.REG_LED1_INTERVAL_OFF;
-            }
-            else
-            {
-               led1.interval.pulses++;
-               led1.interval.off_ms++;
-
-               if (--led1.interval.tail_ms + 1 == 0)
-               {
-                  if (--led1.interval.reps == 0)
-                  {
-                     app_regs.REG_LED_BEHAVING = app_regs.REG_LED_BEHAVING & B_LED0_START;
-                     timer_type0_stop(&TCD0);
-                     
-                     if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_START)
-                        clr_OUT1;
-                     
-                     reti();
-                  }
-
-                  set_LED1_TRANSISTOR;
-            
-                  if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
-                     set_OUT1;
-               
-                  UPDATE_BOARD_LED1;
-                  
-                  app_regs.REG_LED_ON = (app_regs.REG_LED_ON & B_LED0_TO_ON) | B_LED1_TO_ON;
-
-                  led1.interval.on_ms = app_regs.REG_LED1_INTERVAL_ON;
-                  led1.interval.off_ms = app_regs.REG_LED1_INTERVAL_OFF;
-                  led1.interval.pulses = app_regs.REG_LED1_INTERVAL_PULSES;
-                  led1.interval.tail_ms = app_regs.REG_LED1_INTERVAL_TAIL;
-               }
-            }
-         }
-      }
+      EVCH_SYNC = prescaler_events[sync_prescaler_led0];
+   }
+   else
+   {
+      /* Different prescalers can only be started back to back */
+      TCC0.CTRLA = sync_prescaler_led0;
+      TCD0.CTRLA = sync_prescaler_led1;
    }
-
-   reti();
 }
 
-
 /************************************************************************/
-/* REG_POWER_EN                                                         */
+/* PWM engine                                                           */
+/*                                                                      */
+/* Periods are solved in 32 MHz cycles with integer math. The fastest   */
+/* prescaler that fits the period keeps the best duty cycle resolution, */
+/* and the cycles left out of PER by the prescaler are spread by adding */
+/* one tick to some periods, so the average period is exact. Periods    */
+/* longer than the timer's range are generated as intervals.            */
+/* The dithering needs the overflow interrupt on every period, so the   */
+/* hardware PWM rounds its period to the nearest tick instead and keeps */
+/* a single interrupt per train.                                        */
+/*                                                                      */
+/* The timer parameters are computed when the period or duty cycle are  */
+/* written, so the start only loads the timer. A running PWM takes new  */
+/* values through PERBUF and CCABUF, so they apply together at the next */
+/* period boundary. The prescaler isn't buffered, so the new period     */
+/* must fit the running one.                                            */
 /************************************************************************/
-void app_read_REG_POWER_EN(void)
+#define TIMER_CLOCK 32000000UL
+#define TIMER_MAX_TICKS 0x10000UL
+
+#define PWM_MIN_PERIOD 640             // 50 kHz
+#define PWM_MAX_PERIOD 3200000000UL    // 0.01 Hz
+
+#define PWM_FREQ_TO_PERIOD(freq) ((uint32_t)(TIMER_CLOCK / (freq) + 0.5))
+#define PWM_DCYCLE_TO_ON(dcycle, period) ((uint32_t)((dcycle) / 100.0 * (period) + 0.5))
+#define PWM_PERIOD_TO_FREQ(period) ((float)TIMER_CLOCK / (period))
+#define PWM_ON_TO_DCYCLE(on, period) (100.0 * (on) / (period))
+
+/* Dividers of TIMER_PRESCALER_DIV1 to TIMER_PRESCALER_DIV1024 as shifts */
+const uint8_t timer_shifts[] = {0, 0, 1, 2, 3, 6, 8, 10};
+
+uint8_t timer_prescaler(uint32_t period)
 {
-	app_regs.REG_POWER_EN  = (read_LED0_PWR_ON) ? B_LED0_PWR_EN : 0;
-   app_regs.REG_POWER_EN |= (read_LED1_PWR_ON) ? B_LED1_PWR_EN : 0;
+   uint8_t prescaler;
+   
+   for (prescaler = TIMER_PRESCALER_DIV1; prescaler <= TIMER_PRESCALER_DIV1024; prescaler++)
+      if (((period - 1) >> timer_shifts[prescaler]) < TIMER_MAX_TICKS)
+         return prescaler;
+   
+   return 0;
 }
 
-bool app_write_REG_POWER_EN(void *a)
+bool pwm_solve(pwm_t * pwm, uint32_t period, uint32_t on, uint8_t prescaler)
 {
-	uint8_t reg = *((uint8_t*)a);
-
-   if (reg & B_LED0_PWR_EN)
-      set_LED0_PWR_ON;
+   uint8_t shift = timer_shifts[prescaler];
+   uint32_t ticks = period >> shift;
+   uint32_t cca = (on + ((1UL << shift) >> 1)) >> shift;
    
-   if (reg & B_LED0_PWR_DIS)
-      clr_LED0_PWR_ON;
-
-   if (reg & B_LED1_PWR_EN)
-      set_LED1_PWR_ON;
+   /* A dithered period takes one more tick */
+   if (ticks < 2 || ((period - 1) >> shift) >= TIMER_MAX_TICKS)
+      return false;
+   
+   if (cca == 0 || cca >= ticks)
+      return false;
+   
+   pwm->per = ticks - 1;
+   pwm->cca = cca;
+   pwm->divider = 1 << shift;
+   pwm->remainder = period & (pwm->divider - 1);
+   pwm->per_nearest = pwm->per + (((uint32_t)pwm->remainder << 1) >= pwm->divider);
+   pwm->dither = 0;
+   pwm->period = period;
+   pwm->on = cca << shift;
+   
+   return true;
+}
 
-   if (reg & B_LED1_PWR_DIS)
-      clr_LED1_PWR_ON;
+bool pwm_arm(pwm_t * pwm, uint32_t period, uint32_t on)
+{
+   uint8_t prescaler;
+   
+   if (period < PWM_MIN_PERIOD || period > PWM_MAX_PERIOD || on == 0 || on >= period)
+      return false;
+   
+   prescaler = timer_prescaler(period);
+   
+   /* Longer periods are generated as intervals, in microseconds */
+   if (prescaler == 0)
+   {
+      if ((on >> 5) == 0 || ((period - on) >> 5) == 0)
+         return false;
       
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_PWR_EN)
-      if (read_LED0_PWR_ON)
-         set_OUT0; else clr_OUT0;
-         
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_PWR_EN)
-      if (read_LED1_PWR_ON)
-         set_OUT1; else clr_OUT1;
+      pwm->prescaler = 0;
+      pwm->on = on & ~31UL;
+      pwm->period = pwm->on + ((period - on) & ~31UL);
       
-   UPDATE_BOARD_LED0;
-   UPDATE_BOARD_LED1;
-
+      return true;
+   }
+   
+   if (!pwm_solve(pwm, period, on, prescaler))
+      return false;
+   
+   pwm->prescaler = prescaler;
+   
    return true;
 }
 
+void pwm_arm_leds(void)
+{
+   pwm_arm(&led0.pwm, app_regs.REG_LED0_PWM_PERIOD, app_regs.REG_LED0_PWM_ON);
+   pwm_arm(&led1.pwm, app_regs.REG_LED1_PWM_PERIOD, app_regs.REG_LED1_PWM_ON);
+}
 
-/************************************************************************/
-/* REG_LED_BEHAVING                                                     */
-/************************************************************************/
-void app_read_REG_LED_BEHAVING(void) {}
-bool app_write_REG_LED_BEHAVING(void *a)
+/* The hardware PWM isn't dithered and runs the nearest tick */
+uint32_t pwm_period_real(pwm_t * pwm, uint8_t mode)
 {
-	uint8_t reg = *((uint8_t*)a);
+   if (mode == MODE_LED0_PWM_HW && pwm->prescaler)
+      return ((uint32_t)pwm->per_nearest + 1) << timer_shifts[pwm->prescaler];
+   
+   return pwm->period;
+}
 
-	if (reg & B_LED0_START)
+void pwm_start(TC0_t * timer, pwm_t * pwm, uint8_t int_level, bool dither)
+{
+   pwm->dither = 0;
+   
+   timer->CTRLA = TC_CLKSEL_OFF_gc;
+   timer->CTRLFSET = TC_CMD_RESET_gc;
+   timer->PER = (dither) ? pwm->per : pwm->per_nearest;
+   timer->CCA = pwm->cca;
+   timer->INTCTRLA = (dither && pwm->remainder) ? INT_LEVEL_LOW : int_level;
+   timer->INTCTRLB = int_level;
+   timer->CTRLB = TC0_CCAEN_bm | TC_WGMODE_SS_gc;
+   timer_release(timer, pwm->prescaler);
+}
+
+/* Called on the overflow, when PERBUF takes the period after the next one */
+void pwm_dither(TC0_t * timer, pwm_t * pwm)
+{
+   pwm->dither += pwm->remainder;
+   
+   if (pwm->dither >= pwm->divider)
    {
-      if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_PWM)
-      	start_led0_pwm();
-      if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_INTERVAL)
-      	start_led0_interval();
+      pwm->dither -= pwm->divider;
+      timer->PERBUF = pwm->per + 1;
    }
-   
-   if (reg & B_LED0_STOP)
+   else
    {
-      if (TCC0_CTRLA)
-      {
-         clr_LED0_TRANSISTOR;
-      }
+      timer->PERBUF = pwm->per;
+   }
+}
 
-      app_regs.REG_LED_BEHAVING = app_regs.REG_LED_BEHAVING & ~(B_LED0_START);
-      timer_type0_stop(&TCC0);
-      
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_START)
-         clr_OUT0;
-         
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
-         clr_OUT0;
+bool pwm_update(TC0_t * timer, pwm_t * pwm, uint32_t period, uint32_t on, bool nearest)
+{
+   pwm_t solved;
+   
+   if (period < PWM_MIN_PERIOD || on == 0 || on >= period)
+      return false;
+   
+   if (!pwm_solve(&solved, period, on, pwm->prescaler))
+      return false;
+   
+   /* The cache goes first, so a dithering overflow in between already uses it */
+   pwm->per = solved.per;
+   pwm->cca = solved.cca;
+   pwm->divider = solved.divider;
+   pwm->remainder = solved.remainder;
+   pwm->per_nearest = solved.per_nearest;
+   pwm->period = solved.period;
+   pwm->on = solved.on;
+   
+   /* Both buffers must be valid on the same update */
+   timer->CTRLFSET = TC0_LUPD_bm;
+   timer->PERBUF = (nearest) ? solved.per_nearest : solved.per;
+   timer->CCABUF = solved.cca;
+   timer->CTRLFCLR = TC0_LUPD_bm;
+   
+   return true;
+}
+
+bool pwm_accepts_update(uint8_t mode)
+{
+   return mode == MODE_LED0_PWM || mode == MODE_LED0_PWM_HW || mode == MODE_LED0_BURST;
+}
+
+bool pwm_write(TC0_t * timer, pwm_t * pwm, uint8_t mode, uint32_t period, uint32_t on)
+{
+   /* A running PWM is updated on its next period */
+   if (timer->CTRLA)
+   {
+      if (!pwm_accepts_update(mode))
+         return false;
       
-      UPDATE_BOARD_LED0;
+      if (!pwm_update(timer, pwm, period, on, mode == MODE_LED0_PWM_HW))
+         return false;
+      
+      /* Only the software PWM is dithered, it needs the overflow */
+      if (pwm->remainder && mode == MODE_LED0_PWM)
+         timer->INTCTRLA = INT_LEVEL_LOW;
+      
+      return true;
    }
+   
+   return pwm_arm(pwm, period, on);
+}
 
-   if (reg & B_LED1_START)
+/* A count of 0 runs until stopped, counts above 16 bits use a high word */
+void pwm_count(pwm_t * pwm, uint32_t pulses)
+{
+   pwm->forever = (pulses == 0);
+   pwm->count = pulses;
+   pwm->pulses = pulses;
+   pwm->pulses_high = (pulses - 1) >> 16;
+}
+
+/* Called when the low word reaches 0, which wraps it to another 65536 pulses */
+bool pwm_counted(pwm_t * pwm)
+{
+   if (pwm->pulses_high == 0 && !pwm->forever)
+      return true;
+   
+   /* Also wraps when running until stopped, so the pulses left read as 2^32 minus the pulses done */
+   pwm->pulses_high--;
+   return false;
+}
+
+/* Pulses left, where a low word of 0 still has 65536 to go */
+uint32_t pwm_left(uint16_t pulses, uint16_t pulses_high)
+{
+   return (uint16_t)(pulses - 1) + 1UL + ((uint32_t)pulses_high << 16);
+}
+
+void start_interval(const __flash channel_t * ch, uint32_t on_us, uint32_t off_us, uint16_t pulses, uint32_t tail_us, uint32_t reps, bool jitter);
+
+void start_pwm(const __flash channel_t * ch)
+{
+   behaviour_t * led = ch->led;
+   
+   /* Periods longer than the timer's range are generated as intervals */
+   if (led->pwm.prescaler == 0)
    {
-      if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_PWM)
-      	start_led1_pwm();
-      if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_INTERVAL)
-      	start_led1_interval();
+      start_interval(ch, led->pwm.on >> 5, (led->pwm.period - led->pwm.on) >> 5, 1, 0, *ch->pwm_pulses, false);
+      return;
    }
    
-   if (reg & B_LED1_STOP)
+   ch->transistor_port->OUTCLR = ch->transistor;
+   channel_out(ch, ch->out_led_on, false);
+   
+   *ch->mode = MODE_LED0_PWM;
+   pwm_count(&led->pwm, *ch->pwm_pulses);
+   
+   pwm_start(ch->timer, &led->pwm, INT_LEVEL_LOW, true);
+   channel_stopwatch(ch);
+   
+   channel_out(ch, ch->out_led_start, true);
+   channel_behaving(ch, true);
+   channel_led_on(ch, true);
+   
+   channel_board(ch);
+}
+
+void start_pwm_hw(const __flash channel_t * ch)
+{
+   behaviour_t * led = ch->led;
+   uint8_t int_level;
+   
+   /* Periods longer than the timer's range can't be counted by hardware */
+   if (led->pwm.prescaler == 0)
    {
-      if (TCD0_CTRLA)
-      {
-         clr_LED1_TRANSISTOR;
-      }
+      start_pwm(ch);
+      return;
+   }
+   
+   ch->transistor_port->OUTCLR = ch->transistor;
+   int_level = channel_mirror(ch);
+   
+   /* The auxiliary timer overflows after the last pulse, */
+   /* or every 65536 pulses when running until stopped    */
+   pwm_count(&led->pwm, *ch->pwm_pulses);
+   channel_count(ch, led->pwm.pulses);
+   
+   *ch->mode = MODE_LED0_PWM_HW;
+   pwm_start(ch->timer, &led->pwm, int_level, false);
+   
+   channel_out(ch, ch->out_led_start, true);
+   channel_behaving(ch, true);
+   
+   channel_board_running(ch);
+}
 
-      app_regs.REG_LED_BEHAVING = app_regs.REG_LED_BEHAVING & ~(B_LED1_START);
-      timer_type0_stop(&TCD0);
-      
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_START)
-         clr_OUT1;
-         
-      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
-         clr_OUT1;
+/************************************************************************/
+/* Microseconds timebase                                                */
+/*                                                                      */
+/* Durations in microseconds use the slowest prescaler that still keeps */
+/* all of them exact, so long spans are split in fewer periods and the  */
+/* short ones keep their width.                                         */
+/************************************************************************/
+#define US_MIN_TICKS 16
+#define US_TO_TICKS(us, shift) (((uint32_t)(us) << 2) >> (shift))
+
+/* Ranges of the ON, OFF and jitter times, and of the tails and gaps */
+#define INTERVAL_MIN_US 20
+#define INTERVAL_MAX_US 100000000UL    // 100 s
+#define INTERVAL_TAIL_MAX_US 850000000UL
+
+uint8_t us_prescaler(uint32_t durations, uint32_t shortest, uint8_t * shift)
+{
+   uint8_t prescaler = TIMER_PRESCALER_DIV1024;
+   
+   /* Microseconds x4 are ticks of DIV8, DIV64, DIV256 and DIV1024 shifted by 0, 3, 5 and 7 */
+   for (*shift = 7; *shift > 0; prescaler--)
+   {
+      if (((durations << 2) & ((1UL << *shift) - 1)) == 0 && US_TO_TICKS(shortest, *shift) >= US_MIN_TICKS)
+         break;
       
-      UPDATE_BOARD_LED1;
-	}
+      *shift -= (*shift == 3) ? 3 : 2;
+   }
+   
+   return prescaler;
+}
 
-	return true;
+/************************************************************************/
+/* Jittered OFF times                                                   */
+/*                                                                      */
+/* The OFF time of each pulse is drawn from a xorshift generator. The   */
+/* uniform draws scale its top 16 bits and the exponential draws look   */
+/* up the inverse CDF, so both take the same cycles on every pulse.     */
+/* The exponential starts on the minimum, has the configured OFF time   */
+/* as its mean and is clipped to the maximum.                           */
+/************************************************************************/
+#define JITTER_NONE 0
+#define JITTER_UNIFORM 1
+#define JITTER_EXPONENTIAL 2
+
+/* -ln(1 - u) in Q4.12 at the center of 256 bins */
+const uint16_t jitter_exponential[256] PROGMEM = {
+       8,    24,    40,    56,    73,    89,   105,   122,   138,   155,   172,   188,   205,   222,   239,   256,
+     273,   290,   307,   325,   342,   359,   377,   394,   412,   430,   448,   465,   483,   501,   520,   538,
+     556,   574,   593,   611,   630,   649,   668,   686,   705,   724,   744,   763,   782,   802,   821,   841,
+     860,   880,   900,   920,   940,   960,   981,  1001,  1021,  1042,  1063,  1083,  1104,  1125,  1146,  1168,
+    1189,  1210,  1232,  1254,  1275,  1297,  1319,  1342,  1364,  1386,  1409,  1431,  1454,  1477,  1500,  1523,
+    1546,  1570,  1593,  1617,  1641,  1665,  1689,  1713,  1737,  1762,  1787,  1812,  1837,  1862,  1887,  1912,
+    1938,  1964,  1990,  2016,  2042,  2068,  2095,  2122,  2149,  2176,  2203,  2231,  2258,  2286,  2314,  2342,
+    2371,  2400,  2428,  2457,  2487,  2516,  2546,  2576,  2606,  2636,  2667,  2698,  2729,  2760,  2791,  2823,
+    2855,  2887,  2920,  2953,  2986,  3019,  3053,  3086,  3121,  3155,  3190,  3225,  3260,  3296,  3332,  3368,
+    3404,  3441,  3479,  3516,  3554,  3592,  3631,  3670,  3709,  3749,  3789,  3830,  3871,  3912,  3954,  3996,
+    4039,  4082,  4126,  4170,  4214,  4259,  4305,  4351,  4397,  4444,  4492,  4540,  4589,  4638,  4688,  4739,
+    4790,  4842,  4894,  4948,  5001,  5056,  5111,  5167,  5224,  5282,  5341,  5400,  5460,  5521,  5583,  5646,
+    5710,  5775,  5841,  5909,  5977,  6046,  6117,  6189,  6262,  6336,  6412,  6490,  6568,  6649,  6731,  6814,
+    6899,  6987,  7076,  7167,  7260,  7355,  7453,  7553,  7655,  7760,  7868,  7978,  8092,  8209,  8330,  8454,
+    8582,  8714,  8851,  8992,  9138,  9290,  9447,  9611,  9782,  9960, 10146, 10341, 10546, 10762, 10989, 11230,
+   11487, 11760, 12052, 12368, 12709, 13082, 13492, 13947, 14460, 15046, 15730, 16552, 17582, 18960, 21052, 25552
+};
+
+void interval_jitter(interval_t * interval, uint8_t distribution, uint32_t min_us, uint32_t max_us, uint32_t seed)
+{
+   uint32_t shortest = (interval->on_us < min_us) ? interval->on_us : min_us;
+   
+   if (max_us < min_us)
+      max_us = min_us;
+   
+   interval->prescaler = us_prescaler(interval->durations | min_us | max_us, shortest, &interval->shift);
+   interval->jitter = distribution;
+   interval->random = seed;
+   interval->jitter_min = US_TO_TICKS(min_us, interval->shift);
+   interval->jitter_max = US_TO_TICKS(max_us, interval->shift);
+   
+   if (distribution == JITTER_UNIFORM)
+      interval->jitter_span = interval->jitter_max - interval->jitter_min;
+   else
+      interval->jitter_span = (interval->off_us > min_us) ? US_TO_TICKS(interval->off_us - min_us, interval->shift) : 0;
+}
+
+/* Reported when drawn, one period ahead of the OFF time it sets */
+void jitter_report(interval_t * interval, uint32_t ticks)
+{
+   uint32_t off_us = (ticks << interval->shift) >> 2;
+   uint8_t add;
+   
+   if (interval == &led0.interval)
+   {
+      app_regs.REG_LED0_JITTER_OFF_US = off_us;
+      add = ADD_REG_LED0_JITTER_OFF_US;
+   }
+   else
+   {
+      app_regs.REG_LED1_JITTER_OFF_US = off_us;
+      add = ADD_REG_LED1_JITTER_OFF_US;
+   }
+   
+   if (app_regs.REG_EVNT_ENABLE & B_EVT_JITTER)
+      core_func_send_event(add, true);
 }
 
+uint32_t jitter_draw(interval_t * interval)
+{
+   uint32_t x = interval->random;
+   uint32_t span = interval->jitter_span;
+   uint32_t ticks;
+   uint16_t u;
+   
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   interval->random = x;
+   
+   /* span * u, without the 48 bits product */
+   if (interval->jitter == JITTER_UNIFORM)
+   {
+      u = x >> 16;
+      ticks = (span >> 16) * u + (((span & 0xFFFF) * u) >> 16);
+   }
+   else
+   {
+      u = pgm_read_word(&jitter_exponential[x >> 24]);
+      ticks = (span >> 12) * u + (((span & 0x0FFF) * u) >> 12);
+   }
+   
+   ticks += interval->jitter_min;
+   
+   if (ticks > interval->jitter_max)
+      ticks = interval->jitter_max;
+   
+   jitter_report(interval, ticks);
+   
+   return ticks;
+}
 
 /************************************************************************/
-/* REG_LED_ON                                                           */
+/* Interval engine                                                      */
+/*                                                                      */
+/* Each pulse is one single slope PWM period with PER = ON + OFF and    */
+/* CCA = ON, so both edges are generated by the timer. The next period  */
+/* is written to PERBUF/CCABUF on the overflow interrupt and spans that */
+/* don't fit the 16 bits timer are split in two or more periods.        */
+/*                                                                      */
+/* The pulses are nested in up to NEST_LEVELS levels of groups, kept as */
+/* a stack of the units left on each level. Pulses, gap and repetitions */
+/* of the PulseTime modes are the first two levels.                     */
 /************************************************************************/
-void app_read_REG_LED_ON(void)
+#define INTERVAL_MAX_TICKS 0xFFFF
+
+/* A count of 0 on the outermost level repeats it until stopped */
+void interval_nest(interval_t * interval, uint32_t on_us, uint32_t off_us, uint8_t levels, uint32_t * counts, uint32_t * gaps_us)
 {
-	app_regs.REG_LED_ON  = (read_LED0_TRANSISTOR) ? B_LED0_TO_ON : 0;
-   app_regs.REG_LED_ON |= (read_LED1_TRANSISTOR) ? B_LED1_TO_ON : 0;
+   uint8_t i;
+   
+   interval->on_us = on_us;
+   interval->off_us = off_us;
+   interval->levels = levels;
+   interval->durations = on_us | off_us;
+   
+   for (i = 0; i < levels; i++)
+   {
+      interval->count[i] = counts[i];
+      interval->gap_us[i] = gaps_us[i];
+      interval->left[i] = 0;
+      interval->durations |= gaps_us[i];
+   }
+   
+   /* The first pulse climbs to the outermost level and starts every group below */
+   interval->left[levels - 1] = counts[levels - 1];
+   interval->forever = (counts[levels - 1] == 0);
+   interval->repeated = 0;
+   
+   interval->prescaler = us_prescaler(interval->durations, (on_us < off_us) ? on_us : off_us, &interval->shift);
+   
+   interval->on_ticks = 0;
+   interval->off_ticks = 0;
+   interval->last_period = false;
+   interval->jitter = JITTER_NONE;
 }
 
-bool app_write_REG_LED_ON(void *a)
+void interval_init(interval_t * interval, uint32_t on_us, uint32_t off_us, uint16_t pulses, uint32_t tail_us, uint32_t reps)
 {
-	uint8_t reg = *((uint8_t*)a);
+   uint32_t counts[2] = {pulses, reps};
+   uint32_t gaps_us[2] = {tail_us, 0};
    
-   if (reg & B_LED0_TO_ON)
+   interval_nest(interval, on_us, off_us, 2, counts, gaps_us);
+}
+
+/* Walks at most the levels up and down, so the cost is bounded whatever the nesting */
+bool interval_next_pulse(interval_t * interval)
+{
+   uint8_t level = 0;
+   uint32_t gap_ticks = 0;
+   
+   /* Climbs to the innermost level with units left */
+   while (interval->left[level] == 0)
    {
-      set_LED0_TRANSISTOR;
-      UPDATE_BOARD_LED0;
-   }      
+      if (++level == interval->levels)
+      {
+         if (!interval->forever)
+            return false;
+         
+         interval->left[--level] = 1;
+         interval->repeated++;
+      }
+   }
    
-   if (reg & B_LED0_TO_OFF)
+   interval->left[level]--;
+   
+   /* And starts a new group on every level below */
+   while (level)
    {
-      clr_LED0_TRANSISTOR;
-      UPDATE_BOARD_LED0;
+      level--;
+      interval->left[level] = interval->count[level] - 1;
    }
    
-   if (reg & B_LED1_TO_ON)
+   /* The gaps of all the groups this pulse ends are appended to its OFF time */
+   while (level < interval->levels && interval->left[level] == 0)
+      gap_ticks += US_TO_TICKS(interval->gap_us[level++], interval->shift);
+   
+   interval->on_ticks = US_TO_TICKS(interval->on_us, interval->shift);
+   
+   if (interval->jitter)
+      interval->off_ticks = jitter_draw(interval);
+   else
+      interval->off_ticks = US_TO_TICKS(interval->off_us, interval->shift);
+   
+   interval->off_ticks += gap_ticks;
+   
+   return true;
+}
+
+bool interval_next_period(interval_t * interval, uint16_t * per, uint16_t * cca)
+{
+   uint32_t ticks;
+   uint32_t on_ticks;
+   
+   if (interval->on_ticks == 0 && interval->off_ticks == 0)
+      if (!interval_next_pulse(interval))
+         return false;
+   
+   ticks = interval->on_ticks + interval->off_ticks;
+   
+   /* Long spans are split in periods not shorter than half the timer range */
+   if (ticks > INTERVAL_MAX_TICKS)
+      ticks = (ticks > 2 * (uint32_t)INTERVAL_MAX_TICKS) ? INTERVAL_MAX_TICKS : ticks >> 1;
+   
+   on_ticks = (interval->on_ticks < ticks) ? interval->on_ticks : ticks;
+   interval->on_ticks -= on_ticks;
+   interval->off_ticks -= ticks - on_ticks;
+   
+   /* CCA = 0 keeps the output low and CCA > PER keeps it high */
+   *per = ticks - 1;
+   *cca = on_ticks;
+   
+   return true;
+}
+
+void interval_reload(TC0_t * timer, interval_t * interval)
+{
+   uint16_t per, cca;
+   
+   if (interval_next_period(interval, &per, &cca))
    {
-      set_LED1_TRANSISTOR;
-      UPDATE_BOARD_LED1;
-   }      
+      timer->PERBUF = per;
+      timer->CCABUF = cca;
+   }
+   else
+   {
+      timer->CCABUF = 0;
+      interval->last_period = true;
+   }
+}
+
+void interval_start(TC0_t * timer, interval_t * interval)
+{
+   uint16_t per, cca;
    
-   if (reg & B_LED1_TO_OFF)
+   interval_next_period(interval, &per, &cca);
+   
+   timer->CTRLA = TC_CLKSEL_OFF_gc;
+   timer->CTRLFSET = TC_CMD_RESET_gc;
+   timer->PER = per;
+   timer->CCA = cca;
+   timer->INTCTRLA = INT_LEVEL_LOW;
+   timer->INTCTRLB = INT_LEVEL_LOW;
+   timer->CTRLB = TC0_CCAEN_bm | TC_WGMODE_SS_gc;
+   
+   interval_reload(timer, interval);
+   
+   timer_release(timer, interval->prescaler);
+}
+
+/* Starts the interval initialized on the channel */
+void interval_run(const __flash channel_t * ch, bool jitter)
+{
+   behaviour_t * led = ch->led;
+   uint8_t distribution = (app_regs.REG_LED_JITTER & ch->jitter_conf) >> ch->jitter_shift;
+   
+   /* Each start replays the sequence of the seed */
+   if (jitter && distribution)
+      interval_jitter(&led->interval, distribution, *ch->jitter_min, *ch->jitter_max, *ch->jitter_seed);
+   
+   ch->transistor_port->OUTCLR = ch->transistor;
+   interval_start(ch->timer, &led->interval);
+   channel_stopwatch(ch);
+   
+   channel_out(ch, ch->out_led_on, true);
+   channel_out(ch, ch->out_led_start, true);
+   channel_behaving(ch, true);
+   channel_led_on(ch, true);
+   
+   channel_board(ch);
+}
+
+void start_interval(const __flash channel_t * ch, uint32_t on_us, uint32_t off_us, uint16_t pulses, uint32_t tail_us, uint32_t reps, bool jitter)
+{
+   *ch->mode = MODE_LED0_INTERVAL;
+   interval_init(&ch->led->interval, on_us, off_us, pulses, tail_us, reps);
+   interval_run(ch, jitter);
+}
+
+/* Takes the ON and OFF times and then the count and gap of each level from REG_LEDx_NEST */
+void start_nest(const __flash channel_t * ch)
+{
+   uint32_t * nest = ch->nest;
+   uint32_t counts[NEST_LEVELS];
+   uint32_t gaps_us[NEST_LEVELS];
+   uint8_t levels = 0;
+   
+   while (levels < NEST_LEVELS)
    {
-      clr_LED1_TRANSISTOR;
-      UPDATE_BOARD_LED1;
+      counts[levels] = nest[2 + 2 * levels];
+      gaps_us[levels] = nest[3 + 2 * levels];
+      
+      /* A count of 0 repeats its level until stopped, so the levels above are unused */
+      if (counts[levels++] == 0)
+         break;
    }
    
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
-       if (read_LED0_TRANSISTOR)
-           set_OUT0; else clr_OUT0;
-           
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
-       if (read_LED1_TRANSISTOR)
-           set_OUT1; else clr_OUT1;
+   /* Outer levels of a single unit and no gap change nothing */
+   while (levels > 1 && counts[levels - 1] == 1 && gaps_us[levels - 1] == 0)
+      levels--;
+   
+   *ch->mode = MODE_LED0_INTERVAL;
+   interval_nest(&ch->led->interval, nest[0], nest[1], levels, counts, gaps_us);
+   interval_run(ch, true);
+}
+
+/************************************************************************/
+/* Segments engine                                                      */
+/*                                                                      */
+/* Each segment is one or more single slope periods with a constant     */
+/* level (CCA = 0 or CCA > PER), reloaded through PERBUF/CCABUF on the  */
+/* overflow interrupt. Durations use the microseconds timebase.         */
+/************************************************************************/
+#define SEGMENT_MIN_US 20
+#define SEGMENT_MAX_TICKS 0xFFFF
+
+bool segments_write_chunk(segments_t * segments, uint8_t index, uint32_t * chunk)
+{
+   uint8_t i, length;
+   
+   /* Chunks extend the table without leaving a gap of stale entries */
+   if (index > SEGMENTS_MAX - SEGMENTS_CHUNK || index > segments->length)
+      return false;
+   
+   /* A zero duration ends the table */
+   for (length = 0; length < SEGMENTS_CHUNK; length++)
+   {
+      if ((chunk[length] & MSK_SEGMENT_DURATION) == 0)
+         break;
+      
+      if ((chunk[length] & MSK_SEGMENT_DURATION) < SEGMENT_MIN_US)
+         return false;
+   }
+   
+   for (i = 0; i < length; i++)
+      segments->entries[index + i] = chunk[i];
+   
+   segments->length = index + length;
+   
+   return true;
+}
+
+void segments_read_chunk(segments_t * segments, uint8_t index, uint32_t * chunk)
+{
+   uint8_t i;
+   
+   for (i = 0; i < SEGMENTS_CHUNK; i++)
+      chunk[i] = (index + i < segments->length) ? segments->entries[index + i] : 0;
+}
+
+bool segments_next_period(segments_t * segments, uint16_t * per, uint16_t * cca)
+{
+   uint32_t ticks;
+   
+   if (segments->ticks == 0)
+   {
+      if (segments->index == segments->length)
+         return false;
+      
+      segments->loaded = segments->entries[segments->index] & ~MSK_SEGMENT_DURATION;
+      segments->ticks = US_TO_TICKS(segments->entries[segments->index] & MSK_SEGMENT_DURATION, segments->shift);
+      segments->index++;
+   }
    
+   ticks = segments->ticks;
+   
+   /* Long segments are split in periods not shorter than half the timer range */
+   if (ticks > SEGMENT_MAX_TICKS)
+      ticks = (ticks > 2 * (uint32_t)SEGMENT_MAX_TICKS) ? SEGMENT_MAX_TICKS : ticks >> 1;
+   
+   segments->ticks -= ticks;
+   
+   *per = ticks - 1;
+   *cca = (segments->loaded & B_SEGMENT_LED_ON) ? ticks : 0;
+   
+   return true;
+}
+
+void segments_reload(TC0_t * timer, segments_t * segments)
+{
+   uint16_t per, cca;
+   
+   if (segments_next_period(segments, &per, &cca))
+   {
+      timer->PERBUF = per;
+      timer->CCABUF = cca;
+   }
+   else
+   {
+      timer->CCABUF = 0;
+      segments->last_period = true;
+   }
+}
+
+bool segments_start(TC0_t * timer, segments_t * segments)
+{
+   uint8_t i;
+   uint16_t per, cca;
+   uint32_t durations = 0;
+   uint32_t shortest = MSK_SEGMENT_DURATION;
+   uint8_t prescaler;
+   
+   if (segments->length == 0)
+      return false;
+   
+   for (i = 0; i < segments->length; i++)
+   {
+      durations |= segments->entries[i] & MSK_SEGMENT_DURATION;
+      
+      if ((segments->entries[i] & MSK_SEGMENT_DURATION) < shortest)
+         shortest = segments->entries[i] & MSK_SEGMENT_DURATION;
+   }
+   
+   prescaler = us_prescaler(durations, shortest, &segments->shift);
+   
+   segments->index = 0;
+   segments->ticks = 0;
+   segments->last_period = false;
+   
+   segments_next_period(segments, &per, &cca);
+   segments->running = segments->loaded;
+   
+   timer->CTRLA = TC_CLKSEL_OFF_gc;
+   timer->CTRLFSET = TC_CMD_RESET_gc;
+   timer->PER = per;
+   timer->CCA = cca;
+   timer->INTCTRLA = INT_LEVEL_LOW;
+   timer->INTCTRLB = INT_LEVEL_OFF;
+   timer->CTRLB = TC0_CCAEN_bm | TC_WGMODE_SS_gc;
+   
+   segments_reload(timer, segments);
+   
+   timer_release(timer, prescaler);
+   
+   return true;
+}
+
+void start_segments(const __flash channel_t * ch)
+{
+   segments_t * segments = &ch->led->segments;
+   
+   ch->transistor_port->OUTCLR = ch->transistor;
+   
+   if (!segments_start(ch->timer, segments))
+      return;
+   
+   channel_stopwatch(ch);
+   
+   *ch->mode = MODE_LED0_SEGMENTS;
+   
+   channel_out(ch, ch->out_led_on, (segments->running & (B_SEGMENT_LED_ON | B_SEGMENT_OUT)) == (B_SEGMENT_LED_ON | B_SEGMENT_OUT));
+   channel_out(ch, ch->out_led_start, true);
+   channel_behaving(ch, true);
+   channel_led_on(ch, segments->running & B_SEGMENT_LED_ON);
+   
+   channel_board(ch);
+}
+
+/************************************************************************/
+/* Program interpreter                                                  */
+/*                                                                      */
+/* Programs run on the overflow interrupt like the segments. Each WAIT  */
+/* loads one period holding the outputs set by the instructions before  */
+/* it, and those outputs are applied when the period starts running.    */
+/* At most PROGRAM_STEPS instructions run per overflow, so a stretch    */
+/* without a WAIT is padded with short periods instead of stalling the  */
+/* interrupt. Inputs are tested when the period is loaded, one period   */
+/* ahead of the outputs.                                                */
+/************************************************************************/
+#define PROGRAM_STEPS 8
+#define PROGRAM_MAX_TICKS 0xFFFF
+
+#define PROGRAM_LED (1<<0)
+#define PROGRAM_OUT (1<<1)
+#define PROGRAM_POWER (1<<2)
+#define PROGRAM_EVENT (1<<3)
+
+bool program_write_chunk(program_t * program, uint8_t index, uint32_t * chunk)
+{
+   uint8_t i, length;
+   uint32_t arg;
+   
+   /* Chunks extend the program without leaving stale words in a gap */
+   if (index > PROGRAM_MAX - PROGRAM_CHUNK || index > program->length)
+      return false;
+   
+   /* An END ends the table */
+   for (length = 0; length < PROGRAM_CHUNK; length++)
+   {
+      arg = chunk[length] & MSK_PROGRAM_ARG;
+      
+      switch (chunk[length] & MSK_PROGRAM_OP)
+      {
+         case GM_PROGRAM_END:
+            break;
+         case GM_PROGRAM_LED:
+         case GM_PROGRAM_POWER:
+         case GM_PROGRAM_OUT:
+            if (arg > 1)
+               return false;
+            continue;
+         case GM_PROGRAM_WAIT:
+            if (arg < SEGMENT_MIN_US)
+               return false;
+            continue;
+         case GM_PROGRAM_LOOP:
+            if (arg == 0)
+               return false;
+            continue;
+         case GM_PROGRAM_JUMP:
+         case GM_PROGRAM_IF_IN:
+            if ((arg & MSK_PROGRAM_TARGET) >= PROGRAM_MAX)
+               return false;
+            continue;
+         case GM_PROGRAM_NEXT:
+         case GM_PROGRAM_EVENT:
+            continue;
+         default:
+            return false;
+      }
+      
+      break;
+   }
+   
+   for (i = 0; i < length; i++)
+      program->code[index + i] = chunk[i];
+   
+   program->length = index + length;
+   
+   return true;
+}
+
+void program_read_chunk(program_t * program, uint8_t index, uint32_t * chunk)
+{
+   uint8_t i;
+   
+   for (i = 0; i < PROGRAM_CHUNK; i++)
+      chunk[i] = (index + i < program->length) ? program->code[index + i] : 0;
+}
+
+bool program_next_period(program_t * program, uint16_t * per, uint16_t * cca)
+{
+   uint8_t steps;
+   uint32_t word, arg, ticks;
+   bool input;
+   
+   /* A long wait split in periods emits its event once */
+   program->loaded &= ~PROGRAM_EVENT;
+   
+   for (steps = 0; program->ticks == 0; steps++)
+   {
+      if (steps == PROGRAM_STEPS)
+      {
+         program->ticks = US_MIN_TICKS;
+         break;
+      }
+      
+      if (program->pc >= program->length)
+         return false;
+      
+      word = program->code[program->pc++];
+      arg = word & MSK_PROGRAM_ARG;
+      
+      switch (word & MSK_PROGRAM_OP)
+      {
+         case GM_PROGRAM_LED:
+            program->loaded = arg ? (program->loaded | PROGRAM_LED) : (program->loaded & ~PROGRAM_LED);
+            break;
+         case GM_PROGRAM_OUT:
+            program->loaded = arg ? (program->loaded | PROGRAM_OUT) : (program->loaded & ~PROGRAM_OUT);
+            break;
+         case GM_PROGRAM_POWER:
+            program->loaded = arg ? (program->loaded | PROGRAM_POWER) : (program->loaded & ~PROGRAM_POWER);
+            break;
+         case GM_PROGRAM_WAIT:
+            program->ticks = US_TO_TICKS(arg, program->shift);
+            break;
+         case GM_PROGRAM_LOOP:
+            /* Deeper loops end the program */
+            if (program->depth == PROGRAM_LOOPS)
+               return false;
+            
+            program->loop_pc[program->depth] = program->pc;
+            program->loop_count[program->depth] = arg;
+            program->depth++;
+            break;
+         case GM_PROGRAM_NEXT:
+            if (program->depth == 0)
+               break;
+            
+            if (--program->loop_count[program->depth - 1])
+               program->pc = program->loop_pc[program->depth - 1];
+            else
+               program->depth--;
+            break;
+         case GM_PROGRAM_JUMP:
+            program->pc = arg & MSK_PROGRAM_TARGET;
+            break;
+         case GM_PROGRAM_IF_IN:
+            input = (arg & B_PROGRAM_IN1) ? read_IN1 : read_IN0;
+            
+            if (input == ((arg & B_PROGRAM_IN_HIGH) != 0))
+               program->pc = arg & MSK_PROGRAM_TARGET;
+            break;
+         case GM_PROGRAM_EVENT:
+            program->loaded |= PROGRAM_EVENT;
+            program->event = arg;
+            break;
+         default:
+            return false;
+      }
+   }
+   
+   ticks = program->ticks;
+   
+   /* Long waits are split in periods not shorter than half the timer range */
+   if (ticks > PROGRAM_MAX_TICKS)
+      ticks = (ticks > 2 * (uint32_t)PROGRAM_MAX_TICKS) ? PROGRAM_MAX_TICKS : ticks >> 1;
+   
+   program->ticks -= ticks;
+   
+   *per = ticks - 1;
+   *cca = (program->loaded & PROGRAM_LED) ? ticks : 0;
+   
+   return true;
+}
+
+void program_reload(TC0_t * timer, program_t * program)
+{
+   uint16_t per, cca;
+   
+   if (program_next_period(program, &per, &cca))
+   {
+      timer->PERBUF = per;
+      timer->CCABUF = cca;
+   }
+   else
+   {
+      timer->CCABUF = 0;
+      program->last_period = true;
+   }
+}
+
+bool program_start(TC0_t * timer, program_t * program, uint8_t outputs)
+{
+   uint8_t i;
+   uint16_t per, cca;
+   uint32_t durations = 0;
+   uint32_t shortest = MSK_PROGRAM_ARG;
+   uint8_t prescaler;
+   
+   if (program->length == 0)
+      return false;
+   
+   for (i = 0; i < program->length; i++)
+   {
+      if ((program->code[i] & MSK_PROGRAM_OP) != GM_PROGRAM_WAIT)
+         continue;
+      
+      durations |= program->code[i] & MSK_PROGRAM_ARG;
+      
+      if ((program->code[i] & MSK_PROGRAM_ARG) < shortest)
+         shortest = program->code[i] & MSK_PROGRAM_ARG;
+   }
+   
+   prescaler = us_prescaler(durations, shortest, &program->shift);
+   
+   program->pc = 0;
+   program->ticks = 0;
+   program->depth = 0;
+   program->loaded = outputs;
+   program->last_period = false;
+   
+   if (!program_next_period(program, &per, &cca))
+      return false;
+   
+   program->running = program->loaded;
+   
+   timer->CTRLA = TC_CLKSEL_OFF_gc;
+   timer->CTRLFSET = TC_CMD_RESET_gc;
+   timer->PER = per;
+   timer->CCA = cca;
+   timer->INTCTRLA = INT_LEVEL_LOW;
+   timer->INTCTRLB = INT_LEVEL_OFF;
+   timer->CTRLB = TC0_CCAEN_bm | TC_WGMODE_SS_gc;
+   
+   program_reload(timer, program);
+   
+   timer_release(timer, prescaler);
+   
+   return true;
+}
+
+/* Applies the outputs of the period that started running */
+static inline __attribute__((always_inline)) void program_outputs(const __flash channel_t * ch)
+{
+   program_t * program = &ch->led->program;
+   
+   if (program->running & PROGRAM_POWER)
+      ch->power_port->OUTSET = ch->power;
+   else
+      ch->power_port->OUTCLR = ch->power;
+   
+   channel_out(ch, ch->out_software, program->running & PROGRAM_OUT);
+   channel_out(ch, ch->out_pwr_en, program->running & PROGRAM_POWER);
+   channel_out(ch, ch->out_led_on, program->running & PROGRAM_LED);
+   channel_led_on(ch, program->running & PROGRAM_LED);
+   
+   if (program->running & PROGRAM_EVENT)
+   {
+      *ch->program_event = program->event;
+      
+      if (app_regs.REG_EVNT_ENABLE & B_EVT_PROGRAM)
+         core_func_send_event(ch->program_event_add, true);
+   }
+   
+   channel_board(ch);
+}
+
+void start_program(const __flash channel_t * ch)
+{
+   ch->transistor_port->OUTCLR = ch->transistor;
+   
+   /* The supply and OUTx keep their state until an instruction changes them */
+   if (!program_start(ch->timer, &ch->led->program, ((ch->power_port->IN & ch->power) ? PROGRAM_POWER : 0) | ((ch->out_port->IN & ch->out) ? PROGRAM_OUT : 0)))
+      return;
+   
+   channel_stopwatch(ch);
+   
+   *ch->mode = MODE_LED0_PROGRAM;
+   
+   program_outputs(ch);
+   
+   channel_out(ch, ch->out_led_start, true);
+   channel_behaving(ch, true);
+}
+
+/************************************************************************/
+/* Chirp engine                                                         */
+/*                                                                      */
+/* The sweep is built at start with one PER/CCA pair per period. On     */
+/* each overflow the DMA copies the pair of the following period to     */
+/* PERBUF/CCABUF and the auxiliary timer counts the periods like on the */
+/* hardware PWM mode, so the CPU is not used during the sweep.          */
+/************************************************************************/
+bool chirp_build(chirp_t * chirp, float freq_start, float freq_end, uint8_t periods, float dcycle, uint8_t * prescaler)
+{
+   uint8_t i;
+   uint32_t ticks;
+   float clock, freq;
+   
+   /* The prescaler can't change during the sweep, so the slowest period chooses it */
+   *prescaler = timer_prescaler(PWM_FREQ_TO_PERIOD((freq_start < freq_end) ? freq_start : freq_end));
+   
+   if (*prescaler == 0)
+      return false;
+   
+   clock = (float)(TIMER_CLOCK >> timer_shifts[*prescaler]);
+   
+   for (i = 0; i < periods; i++)
+   {
+      freq = freq_start + (freq_end - freq_start) * i / (periods - 1);
+      ticks = clock / freq + 0.5;
+      
+      if (ticks > 0x10000)
+         return false;
+      
+      /* Rounded to the nearest tick, since the sweep isn't dithered */
+      chirp->periods[i].per = ticks - 1;
+      chirp->periods[i].cca = dcycle/100.0 * ticks + 0.5;
+      
+      if (chirp->periods[i].cca == 0 || chirp->periods[i].cca >= ticks)
+         return false;
+   }
+   
+   return true;
+}
+
+void chirp_start(TC0_t * timer, DMA_CH_t * dma, uint8_t trigger, chirp_t * chirp, uint8_t periods, uint8_t prescaler, uint8_t int_level)
+{
+   uint16_t address;
+   
+   timer->CTRLA = TC_CLKSEL_OFF_gc;
+   timer->CTRLFSET = TC_CMD_RESET_gc;
+   timer->PER = chirp->periods[0].per;
+   timer->CCA = chirp->periods[0].cca;
+   timer->PERBUF = chirp->periods[1].per;
+   timer->CCABUF = chirp->periods[1].cca;
+   timer->INTCTRLA = int_level;
+   timer->INTCTRLB = int_level;
+   timer->CTRLB = TC0_CCAEN_bm | TC_WGMODE_SS_gc;
+   
+   dma->CTRLA = 0;
+   dma->CTRLA = DMA_CH_RESET_bm;
+   
+   if (periods > 2)
+   {
+      /* One 4 bytes burst per overflow, from the table to PERBUF and CCABUF */
+      dma->ADDRCTRL = DMA_CH_SRCRELOAD_NONE_gc | DMA_CH_SRCDIR_INC_gc | DMA_CH_DESTRELOAD_BURST_gc | DMA_CH_DESTDIR_INC_gc;
+      dma->TRIGSRC = trigger;
+      dma->TRFCNT = (periods - 2) * sizeof(chirp_period_t);
+      
+      address = (uint16_t)(&chirp->periods[2]);
+      dma->SRCADDR0 = address & 0xFF;
+      dma->SRCADDR1 = address >> 8;
+      dma->SRCADDR2 = 0;
+      
+      address = (uint16_t)(&timer->PERBUF);
+      dma->DESTADDR0 = address & 0xFF;
+      dma->DESTADDR1 = address >> 8;
+      dma->DESTADDR2 = 0;
+      
+      DMA.CTRL = DMA_ENABLE_bm;
+      dma->CTRLA = DMA_CH_ENABLE_bm | DMA_CH_SINGLE_bm | DMA_CH_BURSTLEN_4BYTE_gc;
+   }
+   
+   timer_release(timer, prescaler);
+}
+
+void start_chirp(const __flash channel_t * ch, float freq_start, float freq_end, uint8_t periods, float dcycle)
+{
+   behaviour_t * led = ch->led;
+   uint8_t prescaler;
+   uint8_t int_level;
+   
+   if (!chirp_build(&led->chirp, freq_start, freq_end, periods, dcycle, &prescaler))
+      return;
+   
+   ch->transistor_port->OUTCLR = ch->transistor;
+   int_level = channel_mirror(ch);
+   
+   /* The auxiliary timer overflows after the last period */
+   channel_count(ch, periods);
+   
+   *ch->mode = MODE_LED0_CHIRP;
+   chirp_start(ch->timer, ch->dma, ch->dma_trigger, &led->chirp, periods, prescaler, int_level);
+   
+   channel_out(ch, ch->out_led_start, true);
+   channel_behaving(ch, true);
+   
+   channel_board_running(ch);
+}
+
+/************************************************************************/
+/* Envelope engine                                                      */
+/*                                                                      */
+/* The LED's timer runs a fixed 20 kHz carrier and the overflow writes  */
+/* the next duty cycle to CCABUF, so each carrier period has a full     */
+/* period to be computed and is applied glitch free on the next update. */
+/* The envelope is read from a 256 entries table using the 8 MSB of a   */
+/* 32 bits phase accumulator.                                           */
+/************************************************************************/
+#define ENVELOPE_CARRIER_TICKS 1600    // 20 kHz at 32 MHz
+#define ENVELOPE_PHASE_STEP 214748.3648 // 2^32 / 20 kHz
+
+/* (1 - cos)/2 of a full turn */
+const uint8_t envelope_sine[256] PROGMEM = {
+     0,   0,   0,   0,   1,   1,   1,   2,   2,   3,   4,   5,   5,   6,   7,   9,
+    10,  11,  12,  14,  15,  17,  18,  20,  21,  23,  25,  27,  29,  31,  33,  35,
+    37,  40,  42,  44,  47,  49,  52,  54,  57,  59,  62,  65,  67,  70,  73,  76,
+    79,  82,  85,  88,  90,  93,  97, 100, 103, 106, 109, 112, 115, 118, 121, 124,
+   127, 131, 134, 137, 140, 143, 146, 149, 152, 155, 158, 162, 165, 167, 170, 173,
+   176, 179, 182, 185, 188, 190, 193, 196, 198, 201, 203, 206, 208, 211, 213, 215,
+   218, 220, 222, 224, 226, 228, 230, 232, 234, 235, 237, 238, 240, 241, 243, 244,
+   245, 246, 248, 249, 250, 250, 251, 252, 253, 253, 254, 254, 254, 255, 255, 255,
+   255, 255, 255, 255, 254, 254, 254, 253, 253, 252, 251, 250, 250, 249, 248, 246,
+   245, 244, 243, 241, 240, 238, 237, 235, 234, 232, 230, 228, 226, 224, 222, 220,
+   218, 215, 213, 211, 208, 206, 203, 201, 198, 196, 193, 190, 188, 185, 182, 179,
+   176, 173, 170, 167, 165, 162, 158, 155, 152, 149, 146, 143, 140, 137, 134, 131,
+   128, 124, 121, 118, 115, 112, 109, 106, 103, 100,  97,  93,  90,  88,  85,  82,
+    79,  76,  73,  70,  67,  65,  62,  59,  57,  54,  52,  49,  47,  44,  42,  40,
+    37,  35,  33,  31,  29,  27,  25,  23,  21,  20,  18,  17,  15,  14,  12,  11,
+    10,   9,   7,   6,   5,   5,   4,   3,   2,   2,   1,   1,   1,   0,   0,   0
+};
+
+bool envelope_init(envelope_t * envelope, float freq, float depth, float offset, uint16_t cycles, bool ramp)
+{
+   if (depth + offset > 100.0)
+      return false;
+   
+   envelope->phase = 0;
+   envelope->step = freq * ENVELOPE_PHASE_STEP + 0.5;
+   envelope->offset = offset/100.0 * ENVELOPE_CARRIER_TICKS + 0.5;
+   envelope->depth = depth/100.0 * ENVELOPE_CARRIER_TICKS + 0.5;
+   envelope->cycles = cycles;
+   envelope->ramp = ramp;
+   
+   return true;
+}
+
+bool envelope_next(TC0_t * timer, envelope_t * envelope)
+{
+   uint8_t level;
+   
+   envelope->phase += envelope->step;
+   
+   /* The phase wrapped around */
+   if (envelope->phase < envelope->step)
+      if (--envelope->cycles == 0)
+         return false;
+   
+   level = envelope->phase >> 24;
+   
+   if (!envelope->ramp)
+      level = pgm_read_byte(&envelope_sine[level]);
+   
+   /* A full carrier period leaves CCA above PER and the LED always on */
+   timer->CCABUF = envelope->offset + (((uint32_t)envelope->depth * level + 128) >> 8);
+   
+   return true;
+}
+
+void envelope_start(TC0_t * timer, envelope_t * envelope)
+{
+   timer->CTRLA = TC_CLKSEL_OFF_gc;
+   timer->CTRLFSET = TC_CMD_RESET_gc;
+   timer->PER = ENVELOPE_CARRIER_TICKS - 1;
+   timer->CCA = envelope->offset;
+   timer->INTCTRLA = INT_LEVEL_LOW;
+   timer->INTCTRLB = INT_LEVEL_OFF;
+   timer->CTRLB = TC0_CCAEN_bm | TC_WGMODE_SS_gc;
+   
+   timer_release(timer, TIMER_PRESCALER_DIV1);
+}
+
+void start_envelope(const __flash channel_t * ch, float freq, float depth, float offset, uint16_t cycles, bool ramp)
+{
+   envelope_t * envelope = &ch->led->envelope;
+   
+   if (!envelope_init(envelope, freq, depth, offset, cycles, ramp))
+      return;
+   
+   ch->transistor_port->OUTCLR = ch->transistor;
+   
+   *ch->mode = MODE_LED0_ENVELOPE;
+   envelope_start(ch->timer, envelope);
+   channel_stopwatch(ch);
+   
+   /* The carrier is too fast to be mirrored, so OUTx follows the start on both configurations */
+   channel_out(ch, ch->out_led_start, true);
+   channel_out(ch, ch->out_led_on, true);
+   channel_behaving(ch, true);
+   
+   channel_board_running(ch);
+}
+
+/************************************************************************/
+/* Burst engine                                                         */
+/*                                                                      */
+/* The auxiliary timer runs the interval engine with no output and      */
+/* gates the LED's timer, which runs the armed PWM as the carrier. Its  */
+/* overflow opens the window and its compare A closes it, so the CPU    */
+/* only runs on the windows' edges. A restarted timer clears its output */
+/* and begins the next window on a full carrier period.                 */
+/************************************************************************/
+void burst_start(TC0_t * timer, TC0_t * gate, pwm_t * pwm, interval_t * interval)
+{
+   uint16_t per, cca;
+   
+   interval_next_period(interval, &per, &cca);
+   
+   gate->CTRLA = TC_CLKSEL_OFF_gc;
+   gate->CTRLFSET = TC_CMD_RESET_gc;
+   gate->PER = per;
+   gate->CCA = cca;
+   gate->INTCTRLA = INT_LEVEL_LOW;
+   gate->INTCTRLB = INT_LEVEL_LOW;
+   gate->CTRLB = TC_WGMODE_SS_gc;
+   
+   interval_reload(gate, interval);
+   
+   timer->CTRLA = TC_CLKSEL_OFF_gc;
+   timer->CTRLFSET = TC_CMD_RESET_gc;
+   timer->PER = pwm->per;
+   timer->CCA = pwm->cca;
+   timer->INTCTRLA = INT_LEVEL_OFF;
+   timer->INTCTRLB = INT_LEVEL_OFF;
+   timer->CTRLB = TC0_CCAEN_bm | TC_WGMODE_SS_gc;
+   
+   /* The first window is open from the start */
+   gate->CTRLA = interval->prescaler;
+   timer->CTRLA = pwm->prescaler;
+}
+
+bool burst_open(TC0_t * timer, TC0_t * gate, pwm_t * pwm)
+{
+   if (gate->CCA == 0)
+      return false;
+   
+   /* Split ON spans keep the carrier running */
+   if (timer->CTRLA == TC_CLKSEL_OFF_gc)
+   {
+      /* The carrier armed between windows is taken here */
+      timer->PER = pwm->per;
+      timer->CCA = pwm->cca;
+      timer->CTRLA = pwm->prescaler;
+   }
+   
+   return true;
+}
+
+void burst_close(TC0_t * timer)
+{
+   timer->CTRLA = TC_CLKSEL_OFF_gc;
+   timer->CTRLFSET = TC_CMD_RESTART_gc;
+}
+
+void start_burst(const __flash channel_t * ch, uint32_t on_us, uint32_t off_us, uint16_t pulses, uint32_t tail_us, uint32_t reps)
+{
+   behaviour_t * led = ch->led;
+   
+   /* The carrier must fit the timer */
+   if (led->pwm.prescaler == 0)
+      return;
+   
+   *ch->mode = MODE_LED0_BURST;
+   interval_init(&led->interval, on_us, off_us, pulses, tail_us, reps);
+   
+   ch->transistor_port->OUTCLR = ch->transistor;
+   
+   /* The auxiliary timer is the stopwatch until it starts gating */
+   channel_stopwatch(ch);
+   
+   /* Its register layout is the one used by the interval engine */
+   burst_start(ch->timer, ch->aux, &led->pwm, &led->interval);
+   
+   channel_out(ch, ch->out_led_on, true);
+   channel_out(ch, ch->out_led_start, true);
+   channel_behaving(ch, true);
+   channel_led_on(ch, true);
+   
+   channel_board_running(ch);
+}
+
+/************************************************************************/
+/* Protocol queue                                                       */
+/*                                                                      */
+/* Protocols pushed to REG_LEDx_QUEUE follow the running Pwm or         */
+/* PulseTime protocol. When its last period starts, the first period of */
+/* the next protocol is written to PERBUF/CCABUF, and its mode and      */
+/* prescaler are taken on the following overflow, so the timer is never */
+/* stopped. Queued PWMs replace the armed one, which is armed again     */
+/* from its registers when the chain ends.                              */
+/************************************************************************/
+/* The PWM replaced by a queued one is armed again from the registers */
+static inline __attribute__((always_inline)) void channel_rearm(const __flash channel_t * ch)
+{
+   if (ch->led->queue.rearm)
+   {
+      ch->led->queue.rearm = false;
+      pwm_arm(&ch->led->pwm, *ch->pwm_period, *ch->pwm_on);
+   }
+}
+
+bool queue_push(queue_t * queue, uint32_t * entry)
+{
+   protocol_t * protocol = &queue->entries[queue->tail & (QUEUE_DEPTH - 1)];
+   pwm_t pwm;
+   
+   if ((uint8_t)(queue->tail - queue->head) == QUEUE_DEPTH)
+      return false;
+   
+   protocol->pulses = entry[4] & 0xFFFF;
+   protocol->reps = entry[4] >> 16;
+   
+   if (protocol->pulses == 0)
+      return false;
+   
+   if ((entry[0] & MSK_LED0_CONF) == GM_LED0_PWM)
+   {
+      if (!pwm_arm(&pwm, entry[1], entry[2]))
+         return false;
+      
+      protocol->mode = MODE_LED0_PWM;
+   }
+   else if ((entry[0] & MSK_LED0_CONF) == GM_LED0_INTERVAL_US)
+   {
+      if (entry[1] < INTERVAL_MIN_US || entry[1] > INTERVAL_MAX_US || entry[2] < INTERVAL_MIN_US || entry[2] > INTERVAL_MAX_US || entry[3] > INTERVAL_TAIL_MAX_US)
+         return false;
+      
+      if (protocol->reps == 0)
+         return false;
+      
+      protocol->mode = MODE_LED0_INTERVAL;
+   }
+   else
+   {
+      return false;
+   }
+   
+   protocol->a = entry[1];
+   protocol->b = entry[2];
+   protocol->tail_us = entry[3];
+   
+   /* The entry is complete before the ISR can see it */
+   queue->tail++;
+   
+   return true;
+}
+
+bool queue_load(TC0_t * timer, behaviour_t * led)
+{
+   queue_t * queue = &led->queue;
+   protocol_t * protocol;
+   uint16_t per, cca;
+   
+   if (queue->head == queue->tail)
+      return false;
+   
+   protocol = &queue->entries[queue->head & (QUEUE_DEPTH - 1)];
+   queue->head++;
+   
+   if (protocol->mode == MODE_LED0_PWM)
+   {
+      pwm_arm(&led->pwm, protocol->a, protocol->b);
+      pwm_count(&led->pwm, protocol->pulses);
+      queue->rearm = true;
+   }
+   
+   if (protocol->mode == MODE_LED0_PWM && led->pwm.prescaler)
+   {
+      per = led->pwm.per;
+      cca = led->pwm.cca;
+      queue->mode = MODE_LED0_PWM;
+      queue->prescaler = led->pwm.prescaler;
+   }
+   else
+   {
+      /* Long PWM periods are generated as intervals, like on start */
+      if (protocol->mode == MODE_LED0_PWM)
+         interval_init(&led->interval, led->pwm.on >> 5, (led->pwm.period - led->pwm.on) >> 5, protocol->pulses, 0, 1);
+      else
+         interval_init(&led->interval, protocol->a, protocol->b, protocol->pulses, protocol->tail_us, protocol->reps);
+      
+      interval_next_period(&led->interval, &per, &cca);
+      queue->mode = MODE_LED0_INTERVAL;
+      queue->prescaler = led->interval.prescaler;
+   }
+   
+   timer->CTRLFSET = TC0_LUPD_bm;
+   timer->PERBUF = per;
+   timer->CCABUF = cca;
+   timer->CTRLFCLR = TC0_LUPD_bm;
+   
+   queue->handover = true;
+   
+   return true;
+}
+
+uint8_t queue_activate(TC0_t * timer, queue_t * queue)
+{
+   queue->handover = false;
+   
+   if (timer->CTRLA != queue->prescaler)
+      timer->CTRLA = queue->prescaler;
+   
+   return queue->mode;
+}
+
+/************************************************************************/
+/* Complementary engine                                                 */
+/*                                                                      */
+/* LED0 and LED1 run single slope PWMs with the same period, loaded as a*/
+/* synchronized start so both timers take their clock on the same tick. */
+/* LED1's counter starts LED0's ON time plus the dead time behind, so   */
+/* its pulse begins a dead time after LED0's ends and ends a dead time  */
+/* before LED0's next one. Both edges of both LEDs are generated by the */
+/* timers and, sharing the clock, they can't drift apart. The auxiliary */
+/* timers count the pulses like on the hardware PWM mode.               */
+/************************************************************************/
+
+/* Loads one LED of the pair, still waiting for the synchronized release */
+void complementary_load(const __flash channel_t * ch, uint16_t per, uint16_t cca, uint16_t cnt, uint8_t prescaler)
+{
+   behaviour_t * led = ch->led;
+   uint8_t int_level;
+   
+   ch->transistor_port->OUTCLR = ch->transistor;
+   int_level = channel_mirror(ch);
+   
+   /* Both LEDs generate LED0's count of pulses */
+   pwm_count(&led->pwm, app_regs.REG_LED0_PWM_PULSES_LONG);
+   channel_count(ch, led->pwm.pulses);
+   
+   *ch->mode = MODE_LED0_COMPLEMENTARY;
+   
+   ch->timer->CTRLA = TC_CLKSEL_OFF_gc;
+   ch->timer->CTRLFSET = TC_CMD_RESET_gc;
+   ch->timer->PER = per;
+   ch->timer->CCA = cca;
+   ch->timer->CNT = cnt;
+   ch->timer->INTCTRLA = int_level;
+   ch->timer->INTCTRLB = int_level;
+   ch->timer->CTRLB = TC0_CCAEN_bm | TC_WGMODE_SS_gc;
+   timer_release(ch->timer, prescaler);
+   
+   channel_out(ch, ch->out_led_start, true);
+   channel_behaving(ch, true);
+   
+   channel_board_running(ch);
+}
+
+/* Takes LED0's period and the ON times of both LEDs */
+void start_complementary(void)
+{
+   uint32_t period = app_regs.REG_LED0_PWM_PERIOD;
+   uint8_t prescaler = timer_prescaler(period);
+   uint8_t shift = timer_shifts[prescaler];
+   uint32_t ticks = period >> shift;
+   uint32_t on0 = app_regs.REG_LED0_PWM_ON >> shift;
+   uint32_t on1 = app_regs.REG_LED1_PWM_ON >> shift;
+   uint32_t dead = ((uint32_t)app_regs.REG_LED_DEAD_TIME + (1UL << shift) - 1) >> shift;
+   bool hold = sync_hold;
+   
+   /* ON times are rounded down and the dead time up, so the gaps are never shorter, */
+   /* and one tick at least keeps LED1's counter from starting on its compare match  */
+   if (dead == 0)
+      dead = 1;
+   
+   if (prescaler == 0 || period < PWM_MIN_PERIOD || on0 == 0 || on1 == 0 || on0 + on1 + 2 * dead > ticks)
+      return;
+   
+   /* A chain running on LED1 is dropped */
+   led1.queue.head = led1.queue.tail;
+   led1.queue.handover = false;
+   channel_rearm(&channels[1]);
+   
+   if (!hold)
+      sync_begin();
+   
+   complementary_load(&channels[0], ticks - 1, on0, 0, prescaler);
+   complementary_load(&channels[1], ticks - 1, on1, ticks - on0 - dead, prescaler);
+   
+   if (!hold)
+      sync_release();
+}
+
+/************************************************************************/
+/* Progress                                                             */
+/*                                                                      */
+/* Computed only when REG_LEDx_PROGRESS is read. The engine's counters  */
+/* and the timers are copied with the interrupts disabled and the pulses*/
+/* and times are rebuilt from the copy, so the ISRs keep no counters for*/
+/* it. The interval engine loads one period ahead of the timer, so the  */
+/* buffered period is taken out. Jittered OFF times count as configured.*/
+/************************************************************************/
+#define PROGRESS_PULSES 0             // Pulses started
+#define PROGRESS_REPETITION 1         // Unit of the outermost level running, from 1
+#define PROGRESS_ELAPSED_US 2
+#define PROGRESS_REMAINING_US 3
+
+#define PROGRESS_FOREVER 0xFFFFFFFF   // Remaining time of what runs until stopped
+
+typedef struct
+{
+   uint16_t cnt, per, perbuf, cca, ccabuf;
+   uint8_t flags;
+} timer_snapshot_t;
+
+typedef struct
+{
+   timer_snapshot_t timer, aux;
+   uint8_t mode;
+   bool running;
+   uint16_t pulses, pulses_high;
+   uint32_t left[NEST_LEVELS];
+   uint32_t repeated;
+   uint32_t on_ticks, off_ticks;
+   bool last_period;
+} progress_snapshot_t;
+
+void timer_snapshot(TC0_t * timer, timer_snapshot_t * snapshot)
+{
+   snapshot->cnt = timer->CNT;
+   snapshot->per = timer->PER;
+   snapshot->perbuf = timer->PERBUF;
+   snapshot->cca = timer->CCA;
+   snapshot->ccabuf = timer->CCABUF;
+   snapshot->flags = timer->INTFLAGS;
+}
+
+/* Also when the timer still takes the clock of the synchronized start */
+uint8_t timer_shift(TC0_t * timer)
+{
+   uint8_t prescaler = timer->CTRLA;
+   
+   if (prescaler == TC_CLKSEL_EVCH5_gc)
+      prescaler = (timer == &TCC0) ? sync_prescaler_led0 : sync_prescaler_led1;
+   
+   return timer_shifts[prescaler & 7];
+}
+
+uint32_t progress_us(uint64_t us)
+{
+   return (us > 0xFFFFFFFF) ? 0xFFFFFFFF : us;
+}
+
+/* Periods of period cycles, with left pulses still to be counted on their compare match */
+void progress_pwm(uint32_t * progress, pwm_t * pwm, uint32_t left, timer_snapshot_t * timer, uint32_t period, uint8_t shift)
+{
+   uint32_t done = pwm->count - left;
+   uint32_t before = (timer->cnt >= timer->cca && done) ? done - 1 : done;
+   uint64_t cycles = (uint64_t)before * period + ((uint32_t)timer->cnt << shift);
+   uint64_t total = (uint64_t)pwm->count * period;
+   
+   progress[PROGRESS_PULSES] = before + 1;
+   progress[PROGRESS_REPETITION] = 1;
+   progress[PROGRESS_ELAPSED_US] = progress_us(cycles >> 5);
+   
+   if (pwm->forever)
+      progress[PROGRESS_REMAINING_US] = PROGRESS_FOREVER;
+   else
+      progress[PROGRESS_REMAINING_US] = (total > cycles) ? progress_us((total - cycles) >> 5) : 0;
+}
+
+/* The loaded pulse is found from the units left on each level */
+void progress_interval(uint32_t * progress, interval_t * interval, progress_snapshot_t * snapshot, timer_snapshot_t * timer)
+{
+   uint8_t top = interval->levels - 1;
+   uint8_t shift = interval->shift;
+   uint32_t digit, units = 1;
+   uint32_t pulses = 0;
+   uint64_t group = US_TO_TICKS(interval->on_us, shift) + US_TO_TICKS(interval->off_us, shift);
+   uint64_t start = 0;
+   uint64_t length = group;
+   int64_t elapsed;
+   bool ended = true;
+   bool first = true;
+   bool pending = timer->flags & TC0_OVFIF_bm;
+   bool buffered = !pending && !snapshot->last_period;
+   bool next;
+   uint8_t i;
+   
+   for (i = 0; i <= top; i++)
+   {
+      digit = (i == top && interval->forever) ? snapshot->repeated - 1 : interval->count[i] - 1 - snapshot->left[i];
+      
+      /* Units of this level are groups of the levels below */
+      pulses += digit * units;
+      start += digit * group;
+      units *= interval->count[i];
+      
+      /* The groups the loaded pulse ends append their gaps to it */
+      ended = ended && (snapshot->left[i] == 0);
+      if (ended)
+         length += US_TO_TICKS(interval->gap_us[i], shift);
+      
+      group = group * interval->count[i] + US_TO_TICKS(interval->gap_us[i], shift);
+      
+      if (i < top)
+         first = first && (digit == 0);
+   }
+   
+   /* Ticks up to the end of the loaded period, without the running one's remainder */
+   elapsed = start + length - snapshot->on_ticks - snapshot->off_ticks;
+   
+   if (!(pending && snapshot->last_period))
+      elapsed -= timer->per + 1 - timer->cnt;
+   
+   if (buffered)
+      elapsed -= timer->perbuf + 1;
+   
+   if (elapsed < 0)
+      elapsed = 0;
+   
+   /* The buffered period starts the loaded pulse when the running one ends on its OFF time */
+   next = buffered && timer->ccabuf && timer->cca <= timer->per;
+   
+   progress[PROGRESS_PULSES] = pulses + 1 - next;
+   progress[PROGRESS_REPETITION] = digit + 1 - (next && first);
+   progress[PROGRESS_ELAPSED_US] = progress_us(((uint64_t)elapsed << shift) >> 2);
+   
+   if (interval->forever)
+      progress[PROGRESS_REMAINING_US] = PROGRESS_FOREVER;
+   else
+      progress[PROGRESS_REMAINING_US] = (group > (uint64_t)elapsed) ? progress_us(((group - elapsed) << shift) >> 2) : 0;
+}
+
+/* Pulses, repetition and times of the PWM, interval and burst modes, 0 on the others */
+void progress_read(const __flash channel_t * ch, uint32_t * progress)
+{
+   behaviour_t * led = ch->led;
+   progress_snapshot_t snapshot;
+   uint8_t sreg = SREG;
+   uint8_t i;
+   uint32_t left;
+   
+   cli();
+   snapshot.running = ch->timer->CTRLA != TC_CLKSEL_OFF_gc;
+   snapshot.mode = *ch->mode;
+   timer_snapshot(ch->timer, &snapshot.timer);
+   timer_snapshot(ch->aux, &snapshot.aux);
+   snapshot.pulses = led->pwm.pulses;
+   snapshot.pulses_high = led->pwm.pulses_high;
+   for (i = 0; i < NEST_LEVELS; i++)
+      snapshot.left[i] = led->interval.left[i];
+   snapshot.repeated = led->interval.repeated;
+   snapshot.on_ticks = led->interval.on_ticks;
+   snapshot.off_ticks = led->interval.off_ticks;
+   snapshot.last_period = led->interval.last_period;
+   SREG = sreg;
+   
+   for (i = 0; i < 4; i++)
+      progress[i] = 0;
+   
+   if (!snapshot.running)
+      return;
+   
+   /* A compare match waiting for its interrupt was already counted */
+   if (snapshot.mode == MODE_LED0_PWM)
+   {
+      left = pwm_left(snapshot.pulses, snapshot.pulses_high);
+      if (snapshot.timer.flags & TC0_CCAIF_bm)
+         left--;
+      
+      progress_pwm(progress, &led->pwm, left, &snapshot.timer, led->pwm.period, timer_shift(ch->timer));
+   }
+   
+   /* The auxiliary timer counts the low word up to its PER */
+   if (snapshot.mode == MODE_LED0_PWM_HW || snapshot.mode == MODE_LED0_COMPLEMENTARY)
+   {
+      left = snapshot.aux.per - snapshot.aux.cnt + 1UL + ((uint32_t)snapshot.pulses_high << 16);
+      if (snapshot.aux.flags & TC0_OVFIF_bm)
+         left -= snapshot.aux.per + 1UL;
+      
+      /* These periods aren't dithered, so the timer's PER is the period */
+      progress_pwm(progress, &led->pwm, left, &snapshot.timer, (snapshot.timer.per + 1UL) << timer_shift(ch->timer), timer_shift(ch->timer));
+   }
+   
+   if (snapshot.mode == MODE_LED0_INTERVAL)
+      progress_interval(progress, &led->interval, &snapshot, &snapshot.timer);
+   
+   /* The windows are the intervals of the auxiliary timer */
+   if (snapshot.mode == MODE_LED0_BURST)
+      progress_interval(progress, &led->interval, &snapshot, &snapshot.aux);
+}
+
+/* Duty cycle */
+static inline __attribute__((always_inline)) void channel_compare(const __flash channel_t * ch)
+{
+   behaviour_t * led = ch->led;
+   uint8_t mode = *ch->mode;
+   
+   if (mode == MODE_LED0_PWM)
+   {
+      channel_out(ch, ch->out_led_on, false);
+      channel_led_on(ch, false);
+
+      /* The next protocol takes over after this period */
+      if (--led->pwm.pulses == 0 && pwm_counted(&led->pwm) && !queue_load(ch->timer, led))
+      {
+         channel_behaving(ch, false);
+         
+         timer_type0_stop(ch->timer);
+         
+         channel_out(ch, ch->out_led_start, false);
+         
+         channel_rearm(ch);
+      }
+   }
+   else if (mode == MODE_LED0_PWM_HW || mode == MODE_LED0_CHIRP || mode == MODE_LED0_COMPLEMENTARY)
+   {
+      ch->out_port->OUTCLR = ch->out;
+      return;
+   }
+   else if (mode == MODE_LED0_INTERVAL)
+   {
+      channel_out(ch, ch->out_led_on, false);
+      channel_led_on(ch, false);
+   }
+   
+   channel_board(ch);
+}
+
+/* Overflow */
+static inline __attribute__((always_inline)) void channel_overflow(const __flash channel_t * ch)
+{
+   behaviour_t * led = ch->led;
+   TC0_t * timer = ch->timer;
+   uint8_t mode;
+   
+   if (led->queue.handover)
+      *ch->mode = queue_activate(timer, &led->queue);
+   
+   mode = *ch->mode;
+   
+   /* Goes first, since it runs on every carrier period */
+   if (mode == MODE_LED0_ENVELOPE)
+   {
+      if (!envelope_next(timer, &led->envelope))
+      {
+         channel_behaving(ch, false);
+         timer_type0_stop(timer);
+         
+         channel_out(ch, ch->out_led_start, false);
+         channel_out(ch, ch->out_led_on, false);
+         
+         channel_board(ch);
+      }
+      
+      return;
+   }
+   
+   if (mode == MODE_LED0_PWM)
+   {
+      channel_out(ch, ch->out_led_on, true);
+      channel_led_on(ch, true);
+      
+      channel_board(ch);
+      
+      if (led->pwm.remainder)
+         pwm_dither(timer, &led->pwm);
+   }
+   
+   if (mode == MODE_LED0_PWM_HW || mode == MODE_LED0_CHIRP || mode == MODE_LED0_COMPLEMENTARY)
+      channel_out(ch, ch->out_led_on, true);
+   
+   if (mode == MODE_LED0_INTERVAL)
+   {
+      if (led->interval.last_period)
+      {
+         channel_behaving(ch, false);
+         timer_type0_stop(timer);
+         
+         channel_out(ch, ch->out_led_start, false);
+         
+         channel_rearm(ch);
+         
+         return;
+      }
+      
+      /* A new period starts with the LED on unless it is a split OFF span */
+      if (ch->transistor_port->IN & ch->transistor)
+      {
+         channel_out(ch, ch->out_led_on, true);
+         channel_led_on(ch, true);
+         
+         channel_board(ch);
+      }
+      
+      interval_reload(timer, &led->interval);
+      
+      /* The next protocol takes over after the last period */
+      if (led->interval.last_period)
+         queue_load(timer, led);
+   }
+   
+   if (mode == MODE_LED0_SEGMENTS)
+   {
+      if (led->segments.last_period)
+      {
+         channel_behaving(ch, false);
+         channel_led_on(ch, false);
+         timer_type0_stop(timer);
+         
+         channel_out(ch, ch->out_led_start, false);
+         channel_out(ch, ch->out_led_on, false);
+         
+         channel_board(ch);
+         
+         return;
+      }
+      
+      /* The period loaded on the previous overflow is now running */
+      led->segments.running = led->segments.loaded;
+      
+      channel_out(ch, ch->out_led_on, (led->segments.running & (B_SEGMENT_LED_ON | B_SEGMENT_OUT)) == (B_SEGMENT_LED_ON | B_SEGMENT_OUT));
+      channel_led_on(ch, led->segments.running & B_SEGMENT_LED_ON);
+      
+      channel_board(ch);
+      
+      segments_reload(timer, &led->segments);
+   }
+   
+   if (mode == MODE_LED0_PROGRAM)
+   {
+      if (led->program.last_period)
+      {
+         channel_behaving(ch, false);
+         channel_led_on(ch, false);
+         timer_type0_stop(timer);
+         
+         channel_out(ch, ch->out_led_start, false);
+         channel_out(ch, ch->out_led_on, false);
+         
+         channel_board(ch);
+         
+         return;
+      }
+      
+      /* The period loaded on the previous overflow is now running */
+      led->program.running = led->program.loaded;
+      program_outputs(ch);
+      
+      program_reload(timer, &led->program);
+   }
+}
+
+/* Burst window closed */
+static inline __attribute__((always_inline)) void channel_aux_compare(const __flash channel_t * ch)
+{
+   burst_close(ch->timer);
+   
+   channel_out(ch, ch->out_led_on, false);
+   channel_led_on(ch, false);
+}
+
+/* Pulses counted or burst window opened */
+static inline __attribute__((always_inline)) void channel_aux_overflow(const __flash channel_t * ch)
+{
+   behaviour_t * led = ch->led;
+   
+   if (*ch->mode == MODE_LED0_BURST && !led->interval.last_period)
+   {
+      if (burst_open(ch->timer, ch->aux, &led->pwm))
+      {
+         channel_out(ch, ch->out_led_on, true);
+         channel_led_on(ch, true);
+      }
+      
+      interval_reload(ch->aux, &led->interval);
+      
+      return;
+   }
+   
+   /* Each further overflow counts 65536 pulses of the high word */
+   if ((*ch->mode == MODE_LED0_PWM_HW || *ch->mode == MODE_LED0_COMPLEMENTARY) && !pwm_counted(&led->pwm))
+   {
+      ch->aux->PER = 0xFFFF;
+      return;
+   }
+   
+   /* Pulses counted or last burst done */
+   timer_type0_stop(ch->timer);
+   channel_aux_stop(ch);
+   ch->dma->CTRLA = 0;
+   
+   channel_behaving(ch, false);
+   channel_led_on(ch, false);
+   
+   channel_out(ch, ch->out_led_start, false);
+   
+   channel_board(ch);
+}
+
+/* LED0 Duty Cycle */
+ISR(TCC0_CCA_vect, ISR_NAKED)
+{
+   channel_compare(&channels[0]);
+   reti();
+}
+
+/* LED1 Duty Cycle */
+ISR(TCD0_CCA_vect, ISR_NAKED)
+{
+   channel_compare(&channels[1]);
+   reti();
+}
+
+/* LED0 Overflow */
+ISR(TCC0_OVF_vect, ISR_NAKED)
+{
+   channel_overflow(&channels[0]);
+   reti();
+}
+
+/* LED1 Overflow */
+ISR(TCD0_OVF_vect, ISR_NAKED)
+{
+   channel_overflow(&channels[1]);
+   reti();
+}
+
+/* LED0 burst window closed */
+ISR(TCE0_CCA_vect, ISR_NAKED)
+{
+   channel_aux_compare(&channels[0]);
+   reti();
+}
+
+/* LED0 pulses counted or burst window opened */
+ISR(TCE0_OVF_vect, ISR_NAKED)
+{
+   channel_aux_overflow(&channels[0]);
+   reti();
+}
+
+/* LED1 burst window closed */
+ISR(TCD1_CCA_vect, ISR_NAKED)
+{
+   channel_aux_compare(&channels[1]);
+   reti();
+}
+
+/* LED1 pulses counted or burst window opened */
+ISR(TCD1_OVF_vect, ISR_NAKED)
+{
+   channel_aux_overflow(&channels[1]);
+   reti();
+}
+
+
+/************************************************************************/
+/* Start the configured behaviour                                       */
+/************************************************************************/
+void input_disarm(const __flash channel_t * ch);
+
+void start_led0(void)
+{
+   input_disarm(&channels[0]);
+   
+   /* A chain interrupted by the start doesn't carry on */
+   led0.queue.handover = false;
+   channel_rearm(&channels[0]);
+   
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_PWM)
+      start_pwm(&channels[0]);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_INTERVAL)
+      start_interval(&channels[0], app_regs.REG_LED0_INTERVAL_ON * 1000UL, app_regs.REG_LED0_INTERVAL_OFF * 1000UL, app_regs.REG_LED0_INTERVAL_PULSES, app_regs.REG_LED0_INTERVAL_TAIL * 1000UL, app_regs.REG_LED0_INTERVAL_REPS_LONG, true);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_PWM_HW)
+      start_pwm_hw(&channels[0]);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_SEGMENTS)
+      start_segments(&channels[0]);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_CHIRP)
+      start_chirp(&channels[0], app_regs.REG_LED0_CHIRP_FREQ_START, app_regs.REG_LED0_CHIRP_FREQ_END, app_regs.REG_LED0_CHIRP_PERIODS, app_regs.REG_LED0_PWM_DCYCLE);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_INTERVAL_US)
+      start_interval(&channels[0], app_regs.REG_LED0_INTERVAL_ON_US, app_regs.REG_LED0_INTERVAL_OFF_US, app_regs.REG_LED0_INTERVAL_PULSES, app_regs.REG_LED0_INTERVAL_TAIL_US, app_regs.REG_LED0_INTERVAL_REPS_LONG, true);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_ENVELOPE)
+      start_envelope(&channels[0], app_regs.REG_LED0_ENVELOPE_FREQ, app_regs.REG_LED0_ENVELOPE_DEPTH, app_regs.REG_LED0_ENVELOPE_OFFSET, app_regs.REG_LED0_ENVELOPE_CYCLES, (app_regs.REG_LED_ENVELOPE_SHAPE & MSK_LED0_SHAPE) == GM_LED0_SHAPE_RAMP);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_BURST)
+      start_burst(&channels[0], app_regs.REG_LED0_INTERVAL_ON * 1000UL, app_regs.REG_LED0_INTERVAL_OFF * 1000UL, app_regs.REG_LED0_INTERVAL_PULSES, app_regs.REG_LED0_INTERVAL_TAIL * 1000UL, app_regs.REG_LED0_INTERVAL_REPS_LONG);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_PROGRAM)
+      start_program(&channels[0]);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_NESTED)
+      start_nest(&channels[0]);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED0_CONF) == GM_LED0_COMPLEMENTARY)
+      start_complementary();
+}
+
+void start_led1(void)
+{
+   /* LED1 belongs to LED0's complementary mode while it runs */
+   if (led0_mode == MODE_LED0_COMPLEMENTARY && TCC0.CTRLA)
+      return;
+   
+   input_disarm(&channels[1]);
+   
+   /* A chain interrupted by the start doesn't carry on */
+   led1.queue.handover = false;
+   channel_rearm(&channels[1]);
+   
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_PWM)
+      start_pwm(&channels[1]);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_INTERVAL)
+      start_interval(&channels[1], app_regs.REG_LED1_INTERVAL_ON * 1000UL, app_regs.REG_LED1_INTERVAL_OFF * 1000UL, app_regs.REG_LED1_INTERVAL_PULSES, app_regs.REG_LED1_INTERVAL_TAIL * 1000UL, app_regs.REG_LED1_INTERVAL_REPS_LONG, true);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_PWM_HW)
+      start_pwm_hw(&channels[1]);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_SEGMENTS)
+      start_segments(&channels[1]);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_CHIRP)
+      start_chirp(&channels[1], app_regs.REG_LED1_CHIRP_FREQ_START, app_regs.REG_LED1_CHIRP_FREQ_END, app_regs.REG_LED1_CHIRP_PERIODS, app_regs.REG_LED1_PWM_DCYCLE);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_INTERVAL_US)
+      start_interval(&channels[1], app_regs.REG_LED1_INTERVAL_ON_US, app_regs.REG_LED1_INTERVAL_OFF_US, app_regs.REG_LED1_INTERVAL_PULSES, app_regs.REG_LED1_INTERVAL_TAIL_US, app_regs.REG_LED1_INTERVAL_REPS_LONG, true);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_ENVELOPE)
+      start_envelope(&channels[1], app_regs.REG_LED1_ENVELOPE_FREQ, app_regs.REG_LED1_ENVELOPE_DEPTH, app_regs.REG_LED1_ENVELOPE_OFFSET, app_regs.REG_LED1_ENVELOPE_CYCLES, (app_regs.REG_LED_ENVELOPE_SHAPE & MSK_LED1_SHAPE) == GM_LED1_SHAPE_RAMP);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_BURST)
+      start_burst(&channels[1], app_regs.REG_LED1_INTERVAL_ON * 1000UL, app_regs.REG_LED1_INTERVAL_OFF * 1000UL, app_regs.REG_LED1_INTERVAL_PULSES, app_regs.REG_LED1_INTERVAL_TAIL * 1000UL, app_regs.REG_LED1_INTERVAL_REPS_LONG);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_PROGRAM)
+      start_program(&channels[1]);
+   if ((app_regs.REG_LED_CONFIGURATION & MSK_LED1_CONF) == GM_LED1_NESTED)
+      start_nest(&channels[1]);
+}
+
+/************************************************************************/
+/* Scheduled start                                                      */
+/*                                                                      */
+/* The LEDs in REG_LED_SCHEDULE are loaded SCHEDULE_LEAD_TICKS before   */
+/* the scheduled Harp time and released by the compare B of the core's  */
+/* timestamp timer (TCC1, 32 us per tick) on the scheduled tick.        */
+/* The load runs at low level and what it shows in the registers and on */
+/* OUTx is kept back until the release, which runs at high level.      */
+/************************************************************************/
+#define SCHEDULE_LEAD_TICKS 125        // 4 ms
+#define SCHEDULE_TICKS_PER_SECOND 31250
+
+#define SCHEDULE_IDLE 0
+#define SCHEDULE_LOAD 1
+#define SCHEDULE_RELEASE 2
+
+uint8_t schedule_stage;
+uint32_t schedule_second;              // Time of the next compare
+uint16_t schedule_tick;
+channel_shown_t schedule_shown[2];     // Left by the loaded starts
+
+void schedule_step(void);
+
+void schedule_compare(void)
+{
+   uint16_t tick = schedule_tick;
+   
+   /* The compare is only set on the second it belongs to */
+   if (core_func_read_R_TIMESTAMP_SECOND() != schedule_second)
+      return;
+   
+   if (tick <= TCC1.CNT)
+   {
+      if (schedule_stage == SCHEDULE_RELEASE)
+      {
+         schedule_step();
+         return;
+      }
+      
+      /* A late load is still taken from the low level compare */
+      tick = TCC1.CNT + 2;
+      if (tick >= SCHEDULE_TICKS_PER_SECOND)
+         tick -= SCHEDULE_TICKS_PER_SECOND;
+   }
+   
+   TCC1.CCB = tick;
+   TCC1.INTFLAGS = TC1_CCBIF_bm;
+   TCC1.INTCTRLB = (TCC1.INTCTRLB & ~TC1_CCBINTLVL_gm) | ((schedule_stage == SCHEDULE_LOAD) ? TC_CCBINTLVL_LO_gc : TC_CCBINTLVL_HI_gc);
+}
+
+void schedule_step(void)
+{
+   const __flash channel_t * ch;
+   channel_shown_t shown;
+   uint8_t i;
+   
+   TCC1.INTCTRLB &= ~TC1_CCBINTLVL_gm;
+   
+   if (schedule_stage == SCHEDULE_LOAD)
+   {
+      sync_begin();
+      
+      for (i = 0; i < 2; i++)
+      {
+         ch = &channels[i];
+         
+         if (!(app_regs.REG_LED_SCHEDULE & ch->start))
+            continue;
+         
+         channel_save(ch, &shown);
+         
+         if (i == 0)
+            start_led0();
+         else
+            start_led1();
+         
+         channel_save(ch, &schedule_shown[i]);
+         channel_show(ch, &shown);
+      }
+      
+      sync_hold = false;
+      
+      /* Cancelled while loading */
+      if (schedule_stage != SCHEDULE_LOAD)
+         return;
+      
+      schedule_stage = SCHEDULE_RELEASE;
+      schedule_second = app_regs.REG_LED_SCHEDULE_SECOND;
+      schedule_tick = app_regs.REG_LED_SCHEDULE_MICRO;
+      schedule_compare();
+   }
+   else if (schedule_stage == SCHEDULE_RELEASE)
+   {
+      sync_release();
+      
+      /* Unless stopped since the load */
+      for (i = 0; i < 2; i++)
+         if ((app_regs.REG_LED_SCHEDULE & channels[i].start) && channels[i].timer->CTRLA != TC_CLKSEL_OFF_gc)
+            channel_show(&channels[i], &schedule_shown[i]);
+      
+      schedule_stage = SCHEDULE_IDLE;
+      app_regs.REG_LED_SCHEDULE = 0;
+   }
+}
+
+void schedule_new_second(void)
+{
+   if (schedule_stage != SCHEDULE_IDLE)
+      schedule_compare();
+}
+
+/* Load at low level and scheduled time at high level */
+ISR(TCC1_CCB_vect)
+{
+   schedule_step();
+}
+
+/************************************************************************/
+/* Input actions                                                        */
+/*                                                                      */
+/* Each input is muxed to an event channel that triggers a DMA channel, */
+/* so its action is taken a few cycles after the edge without the CPU.  */
+/* The supply and LED on actions toggle their pin on every edge. A      */
+/* start is armed while the LED is idle: the behaviour is loaded with   */
+/* the timer stopped and the rising edge has the DMA write its          */
+/* prescaler to CTRLA. Only prescalers up to DIV8 are armed, as a       */
+/* slower one would add up to a tick to the latency. The loaded timer   */
+/* holds the transistor's pin, so writing REG_LED_ON unloads it, and an */
+/* LED driven by the other input's LED on action isn't armed. The       */
+/* edge's interrupt then resyncs the pins to the input, shows the start */
+/* in the registers and starts in software whatever couldn't be armed.  */
+/************************************************************************/
+#define INPUT_PWR_EN 0
+#define INPUT_START 1
+#define INPUT_ON 2
+
+typedef struct
+{
+   PORT_t * port;
+   uint8_t pin;                     // Pin mask
+   register8_t * evch;
+   register8_t * evctrl;
+   uint8_t source;                  // The pin as event
+   register8_t * intmask;
+   uint8_t intflag;
+   DMA_CH_t * dma;
+   uint8_t trigger;                 // The event channel as DMA trigger
+   uint8_t conf_shift;              // Field of REG_IN_CONFIGURATION
+} input_t;
+
+const __flash input_t inputs[] = {
+   {&PORTD, 1 << 4, &EVSYS_CH0MUX, &EVSYS_CH0CTRL, EVSYS_CHMUX_PORTD_PIN4_gc, &PORTD.INT0MASK, PORT_INT0IF_bm, &DMA.CH2, DMA_CH_TRIGSRC_EVSYS_CH0_gc, 0},
+   {&PORTD, 1 << 3, &EVSYS_CH2MUX, &EVSYS_CH2CTRL, EVSYS_CHMUX_PORTD_PIN3_gc, &PORTD.INT1MASK, PORT_INT1IF_bm, &DMA.CH3, DMA_CH_TRIGSRC_EVSYS_CH2_gc, 4}
+};
+
+typedef struct
+{
+   const __flash channel_t * ch;    // 0 when the input controls nothing
+   uint8_t action;
+   uint8_t mask;                    // Written to OUTTGL by the DMA
+   uint8_t prescaler;               // Written to CTRLA by the DMA
+   bool armed;
+   bool refused;                    // The behaviour can't be armed until a register is written
+   channel_shown_t shown;           // Registers and pins left by the armed start
+} input_state_t;
+
+input_state_t input_states[2];
+
+void input_pin(PORT_t * port, uint8_t mask, bool level)
+{
+   if (level)
+      port->OUTSET = mask;
+   else
+      port->OUTCLR = mask;
+}
+
+/* One byte moved from source to destination on each edge */
+void input_dma(const __flash input_t * in, uint8_t * source, register8_t * destination, uint8_t repeat)
+{
+   DMA_CH_t * dma = in->dma;
+   uint16_t address;
+   
+   dma->CTRLA = 0;
+   dma->CTRLA = DMA_CH_RESET_bm;
+   
+   dma->ADDRCTRL = DMA_CH_SRCRELOAD_NONE_gc | DMA_CH_SRCDIR_FIXED_gc | DMA_CH_DESTRELOAD_NONE_gc | DMA_CH_DESTDIR_FIXED_gc;
+   dma->TRIGSRC = in->trigger;
+   dma->TRFCNT = 1;
+   dma->REPCNT = 0;                 // Repeated without end
+   
+   address = (uint16_t)source;
+   dma->SRCADDR0 = address & 0xFF;
+   dma->SRCADDR1 = address >> 8;
+   dma->SRCADDR2 = 0;
+   
+   address = (uint16_t)destination;
+   dma->DESTADDR0 = address & 0xFF;
+   dma->DESTADDR1 = address >> 8;
+   dma->DESTADDR2 = 0;
+   
+   DMA.CTRL = DMA_ENABLE_bm;
+   dma->CTRLA = DMA_CH_ENABLE_bm | repeat | DMA_CH_SINGLE_bm | DMA_CH_BURSTLEN_1BYTE_gc;
+}
+
+/* Shows the start made by the DMA, unless the behaviour is already over */
+void input_started(input_state_t * state)
+{
+   const __flash channel_t * ch = state->ch;
+   
+   if (ch->timer->CTRLA == TC_CLKSEL_OFF_gc)
+      return;
+   
+   channel_show(ch, &state->shown);
+}
+
+/* The behaviour loaded for an armed start holds the LED's pin until it is stopped */
+void input_unload(const __flash channel_t * ch)
+{
+   ch->dma->CTRLA = 0;
+   timer_type0_stop(ch->timer);
+   
+   /* Unless it is already the stopwatch of a start command */
+   if (ch->aux->CTRLA != TC_CLKSEL_DIV1_gc)
+      channel_aux_stop(ch);
+}
+
+/* Leaves the LED to the behaviours */
+void input_disarm(const __flash channel_t * ch)
+{
+   uint8_t i;
+   
+   for (i = 0; i < 2; i++)
+   {
+      if (input_states[i].ch != ch || !input_states[i].armed || input_states[i].action == INPUT_PWR_EN)
+         continue;
+      
+      inputs[i].dma->CTRLA = 0;
+      input_states[i].armed = false;
+      
+      if (input_states[i].action != INPUT_START)
+         continue;
+      
+      /* The edge came before its interrupt */
+      if (inputs[i].dma->CTRLB & DMA_CH_TRNIF_bm)
+         input_started(&input_states[i]);
+      else
+         input_unload(ch);
+   }
+}
+
+/* Gives the LED's pin back to the port, the LED on action is kept */
+void input_disarm_start(const __flash channel_t * ch)
+{
+   uint8_t i;
+   
+   for (i = 0; i < 2; i++)
+      if (input_states[i].ch == ch && input_states[i].armed && input_states[i].action == INPUT_START)
+         input_disarm(ch);
+}
+
+/* An LED takes one armed action at a time */
+bool input_channel_armed(const __flash channel_t * ch)
+{
+   uint8_t i;
+   
+   for (i = 0; i < 2; i++)
+      if (input_states[i].ch == ch && input_states[i].armed && input_states[i].action != INPUT_PWR_EN)
+         return true;
+   
+   return false;
+}
+
+/* The supply and LED on actions toggle their pin from the input's level */
+void input_toggle(const __flash input_t * in, input_state_t * state)
+{
+   const __flash channel_t * ch = state->ch;
+   PORT_t * port = (state->action == INPUT_PWR_EN) ? ch->power_port : ch->transistor_port;
+   bool level;
+   
+   state->mask = (state->action == INPUT_PWR_EN) ? ch->power : ch->transistor;
+   input_dma(in, &state->mask, &port->OUTTGL, DMA_CH_REPEAT_bm);
+   state->armed = true;
+   
+   /* Read after the DMA is enabled, so an edge in between isn't lost */
+   level = in->port->IN & in->pin;
+   input_pin(port, state->mask, level);
+   channel_out(ch, (state->action == INPUT_PWR_EN) ? ch->out_pwr_en : ch->out_led_on, level);
+   channel_board(ch);
+}
+
+void input_arm_on(const __flash input_t * in, input_state_t * state)
+{
+   const __flash channel_t * ch = state->ch;
+   
+   if (ch->timer->CTRLA != TC_CLKSEL_OFF_gc || input_channel_armed(ch))
+      return;
+   
+   input_toggle(in, state);
+}
+
+void input_arm_start(const __flash input_t * in, input_state_t * state)
+{
+   const __flash channel_t * ch = state->ch;
+   input_state_t * other;
+   channel_shown_t shown;
+   uint8_t conf = app_regs.REG_LED_CONFIGURATION;
+   
+   if (state->refused || (in->port->IN & in->pin))
+      return;
+   
+   /* The LED is idle and dark, with no other start on the way */
+   if (ch->timer->CTRLA != TC_CLKSEL_OFF_gc || (ch->transistor_port->IN & ch->transistor) || input_channel_armed(ch))
+      return;
+   if (sync_hold || schedule_stage != SCHEDULE_IDLE)
+      return;
+   
+   /* The other input's LED on action takes the pin, this start is made in software */
+   other = (state == &input_states[0]) ? &input_states[1] : &input_states[0];
+   if (other->ch == ch && other->action == INPUT_ON)
+      return;
+   
+   /* These starts take more than the prescaler */
+   conf = ((ch == &channels[0]) ? conf : conf >> 4) & MSK_LED0_CONF;
+   if (conf == GM_LED0_BURST || conf == GM_LED0_PROGRAM || conf == GM_LED0_COMPLEMENTARY)
+   {
+      state->refused = true;
+      return;
+   }
+   
+   channel_save(ch, &shown);
+   
+   state->prescaler = TC_CLKSEL_OFF_gc;
+   input_hold = &state->prescaler;
+   
+   if (ch == &channels[0])
+      start_led0();
+   else
+      start_led1();
+   
+   input_hold = 0;
+   
+   if (state->prescaler == TC_CLKSEL_OFF_gc)
+   {
+      state->refused = true;
+      return;
+   }
+   
+   /* A slower prescaler adds up to a tick to the latency, so it is started in software */
+   if (state->prescaler > TIMER_PRESCALER_DIV8)
+   {
+      input_unload(ch);
+      channel_show(ch, &shown);
+      state->refused = true;
+      return;
+   }
+   
+   /* What the start shows is kept for the edge */
+   channel_save(ch, &state->shown);
+   channel_show(ch, &shown);
+   
+   input_dma(in, &state->prescaler, &ch->timer->CTRLA, 0);
+   state->armed = true;
+}
+
+extern uint16_t input_holdoff_ms[2];
+
+/* Arms the LEDs that became idle, from the 1 ms callback */
+void inputs_arm(void)
+{
+   uint8_t i;
+   
+   for (i = 0; i < 2; i++)
+   {
+      /* Inputs in their hold-off are armed when it ends */
+      if (input_states[i].ch == 0 || input_states[i].armed || input_holdoff_ms[i])
+         continue;
+      
+      if (input_states[i].action == INPUT_ON)
+         input_arm_on(&inputs[i], &input_states[i]);
+      if (input_states[i].action == INPUT_START)
+         input_arm_start(&inputs[i], &input_states[i]);
+   }
+}
+
+/* Called after a successful write to a register an armed start loads, */
+/* so the start is armed again right away with the new content          */
+void inputs_reload(void)
+{
+   uint8_t i;
+   
+   for (i = 0; i < 2; i++)
+   {
+      if (input_states[i].action != INPUT_START)
+         continue;
+      
+      if (input_states[i].armed)
+         input_disarm(input_states[i].ch);
+      
+      input_states[i].refused = false;
+   }
+   
+   inputs_arm();
+}
+
+void inputs_configure(void)
+{
+   uint8_t i, conf;
+   
+   for (i = 0; i < 2; i++)
+   {
+      const __flash input_t * in = &inputs[i];
+      input_state_t * state = &input_states[i];
+      
+      if (state->ch)
+         input_disarm(state->ch);
+      in->dma->CTRLA = 0;
+      
+      /* LED0's actions are 0 to 2 and LED1's 3 to 5, in the same order */
+      conf = (app_regs.REG_IN_CONFIGURATION >> in->conf_shift) & MSK_IN0_CONF;
+      
+      state->ch = (conf < GM_IN0_CONF_NOT) ? &channels[conf / 3] : 0;
+      state->action = conf % 3;
+      state->armed = false;
+      state->refused = false;
+      
+      *in->evch = in->source;
+      *in->evctrl = app_regs.REG_IN_FILTER_SAMPLES[i] - 1;
+      
+      /* The supply is never driven by the behaviours */
+      if (state->ch && state->action == INPUT_PWR_EN)
+         input_toggle(in, state);
+   }
+   
+   inputs_arm();
+}
+
+/* Called by the input's interrupt, after the DMA */
+void input_edge(uint8_t input)
+{
+   const __flash input_t * in = &inputs[input];
+   input_state_t * state = &input_states[input];
+   const __flash channel_t * ch = state->ch;
+   bool level = in->port->IN & in->pin;
+   
+   if (ch == 0)
+      return;
+   
+   /* A missed or bounced edge leaves the toggled pins out of step */
+   if (state->action == INPUT_PWR_EN)
+   {
+      input_pin(ch->power_port, ch->power, level);
+      channel_out(ch, ch->out_pwr_en, level);
+      channel_board(ch);
+   }
+   
+   if (state->action == INPUT_ON && state->armed)
+   {
+      input_pin(ch->transistor_port, ch->transistor, level);
+      channel_out(ch, ch->out_led_on, level);
+      channel_board(ch);
+   }
+   
+   if (state->action == INPUT_START)
+   {
+      if (state->armed && (in->dma->CTRLB & DMA_CH_TRNIF_bm))
+      {
+         state->armed = false;
+         input_started(state);
+         input_disarm(ch);
+      }
+      else if (level)
+      {
+         if (state->armed)
+         {
+            /* The edge came before the DMA was enabled */
+            in->dma->CTRLA = 0;
+            state->armed = false;
+            ch->timer->CTRLA = state->prescaler;
+            input_started(state);
+            input_disarm(ch);
+         }
+         else if (ch == &channels[0])
+         {
+            start_led0();
+         }
+         else
+         {
+            start_led1();
+         }
+      }
+   }
+}
+
+/************************************************************************/
+/* Input capture                                                        */
+/*                                                                      */
+/* Edges of the inputs in REG_IN_CAPTURE are stamped in software from   */
+/* the core's timestamp timer (TCC1, 32 us per tick) first thing in     */
+/* their interrupt, so a stamp is late by the interrupt's latency on    */
+/* top of the tick. The level is the pin's when the interrupt reads it, */
+/* so edges closer than that latency may report the level of the later  */
+/* one. This isn't a hardware capture. The edges are batched and the    */
+/* batch goes out as one IN_CAPTURE_EVENT with the time of its first    */
+/* edge after REG_IN_CAPTURE_EDGES edges or REG_IN_CAPTURE_PERIOD ms,   */
+/* each entry holding the ticks since the edge before. A gap too long   */
+/* for an entry starts a new batch.                                     */
+/************************************************************************/
+#define CAPTURE_EDGES 16
+
+uint16_t capture_entries[CAPTURE_EDGES];
+uint8_t capture_count;
+uint32_t capture_second, capture_last_second;
+uint16_t capture_tick, capture_last_tick;
+uint16_t capture_ms;                   // Age of the batch
+
+/* The second of a tick taken while the overflow is still waiting for its interrupt is counted */
+void timestamp_read(uint32_t * second, uint16_t * tick)
+{
+   do
+   {
+      *second = core_func_read_R_TIMESTAMP_SECOND();
+      *tick = TCC1.CNT;
+   } while (*second != core_func_read_R_TIMESTAMP_SECOND());
+   
+   if ((TCC1.INTFLAGS & TC1_OVFIF_bm) && *tick < SCHEDULE_TICKS_PER_SECOND / 2)
+      (*second)++;
+}
+
+void capture_send(void)
+{
+   uint8_t sreg = SREG;
+   uint8_t i;
+   
+   cli();
+   if (capture_count == 0)
+   {
+      SREG = sreg;
+      return;
+   }
+   
+   for (i = 0; i < CAPTURE_EDGES; i++)
+      app_regs.REG_IN_CAPTURE_EVENT[i] = (i < capture_count) ? capture_entries[i] : CAPTURE_UNUSED;
+   
+   capture_count = 0;
+   SREG = sreg;
+   
+   if (app_regs.REG_EVNT_ENABLE & B_EVT_IN_CAPTURE)
+   {
+      core_func_update_user_timestamp(capture_second, capture_tick);
+      core_func_send_event(ADD_REG_IN_CAPTURE_EVENT, false);
+   }
+}
+
+/* Called first by the input's interrupt */
+void capture_edge(uint8_t input)
+{
+   uint32_t second;
+   uint16_t tick;
+   uint32_t delta = 0;
+   
+   if (!(app_regs.REG_IN_CAPTURE & (input ? B_IN1_CAPTURE : B_IN0_CAPTURE)))
+      return;
+   
+   timestamp_read(&second, &tick);
+   
+   if (capture_count)
+   {
+      if (second - capture_last_second > 1)
+         delta = MSK_CAPTURE_DELTA;
+      else
+         delta = (second - capture_last_second) * SCHEDULE_TICKS_PER_SECOND + tick - capture_last_tick;
+      
+      if (delta >= MSK_CAPTURE_DELTA)
+      {
+         capture_send();
+         delta = 0;
+      }
+   }
+   
+   if (capture_count == 0)
+   {
+      capture_second = second;
+      capture_tick = tick;
+      capture_ms = 0;
+   }
+   
+   /* Sampled now, not at the edge */
+   capture_entries[capture_count++] = delta | (input ? B_CAPTURE_IN1 : 0) | ((inputs[input].port->IN & inputs[input].pin) ? B_CAPTURE_HIGH : 0);
+   capture_last_second = second;
+   capture_last_tick = tick;
+   
+   if (capture_count >= app_regs.REG_IN_CAPTURE_EDGES)
+      capture_send();
+}
+
+/* Called by the 1 ms callback */
+void capture_timeout(void)
+{
+   if (capture_count == 0 || app_regs.REG_IN_CAPTURE_PERIOD == 0)
+      return;
+   
+   if (++capture_ms >= app_regs.REG_IN_CAPTURE_PERIOD)
+      capture_send();
+}
+
+/************************************************************************/
+/* Input events                                                         */
+/*                                                                      */
+/* Each input's field of REG_IN_EVENT_CONF picks which of its edges     */
+/* send IN_STATE. The rate limit sends IN_EDGES instead, at most once   */
+/* per REG_IN_EVENT_PERIOD_US, and the 1 ms callback sends the edges    */
+/* left over once the period is over. An edge only counts, compares and */
+/* decrements, so the policies take constant time in the interrupt.     */
+/************************************************************************/
+typedef struct
+{
+   uint16_t edges;                  // Left until the next event, every Nth edge
+   bool pending;                    // Edges not sent by the rate limit
+   uint32_t last;                   // Ticks of the last rate limited event
+} input_events_t;
+
+input_events_t input_events[2];
+
+/* 32 us ticks, wrapping */
+uint32_t input_events_now(void)
+{
+   uint32_t second;
+   uint16_t tick;
+   
+   timestamp_read(&second, &tick);
+   
+   return second * SCHEDULE_TICKS_PER_SECOND + tick;
+}
+
+bool input_events_elapsed(uint8_t input, uint32_t now)
+{
+   return now - input_events[input].last >= (app_regs.REG_IN_EVENT_PERIOD_US[input] + 31) >> 5;
+}
+
+void input_events_reset(void)
+{
+   input_events[0].edges = app_regs.REG_IN_EVENT_NTH[0];
+   input_events[1].edges = app_regs.REG_IN_EVENT_NTH[1];
+   input_events[0].pending = false;
+   input_events[1].pending = false;
+}
+
+/* Called by the input's interrupt when IN_STATE changed */
+void input_event(uint8_t input)
+{
+   input_events_t * events = &input_events[input];
+   uint8_t policy = (app_regs.REG_IN_EVENT_CONF >> (input ? 4 : 0)) & MSK_IN0_EVENT;
+   bool high = app_regs.REG_IN_STATE & (input ? B_IN1 : B_IN0);
+   bool send = false;
+   uint32_t now;
+   
+   app_regs.REG_IN_EDGES[input]++;
+   
+   switch (policy)
+   {
+      case GM_IN0_EVENT_EDGES:
+         send = true;
+         break;
+      case GM_IN0_EVENT_RISING:
+         send = high;
+         break;
+      case GM_IN0_EVENT_FALLING:
+         send = !high;
+         break;
+      case GM_IN0_EVENT_NTH:
+         if (--events->edges == 0)
+         {
+            events->edges = app_regs.REG_IN_EVENT_NTH[input];
+            send = true;
+         }
+         break;
+      case GM_IN0_EVENT_RATE:
+         now = input_events_now();
+         
+         if (input_events_elapsed(input, now))
+         {
+            events->last = now;
+            events->pending = false;
+            
+            if (app_regs.REG_EVNT_ENABLE & B_EVT_IN_STATE)
+               core_func_send_event(ADD_REG_IN_EDGES, true);
+         }
+         else
+         {
+            events->pending = true;
+         }
+         break;
+   }
+   
+   if (send && (app_regs.REG_EVNT_ENABLE & B_EVT_IN_STATE))
+      core_func_send_event(ADD_REG_IN_STATE, true);
+}
+
+/* Called by the 1 ms callback */
+void input_events_timeout(void)
+{
+   uint8_t sreg;
+   uint8_t i;
+   bool send;
+   uint32_t now;
+   
+   for (i = 0; i < 2; i++)
+   {
+      if (!input_events[i].pending)
+         continue;
+      
+      sreg = SREG;
+      cli();
+      now = input_events_now();
+      send = input_events[i].pending && input_events_elapsed(i, now);
+      if (send)
+      {
+         input_events[i].last = now;
+         input_events[i].pending = false;
+      }
+      SREG = sreg;
+      
+      if (send && (app_regs.REG_EVNT_ENABLE & B_EVT_IN_STATE))
+         core_func_send_event(ADD_REG_IN_EDGES, true);
+   }
+}
+
+/************************************************************************/
+/* Input filtering                                                      */
+/*                                                                      */
+/* The event channels only pass edges that hold REG_IN_FILTER_SAMPLES   */
+/* samples of the peripheral clock, so glitches never reach the DMA.    */
+/* That filter is too short for mechanical bounces, and the pin        */
+/* interrupts can't be filtered in hardware. After an edge the pin      */
+/* interrupt is masked and the DMA of a supply or LED on action is      */
+/* disabled for REG_IN_HOLDOFF_MS ms, so the bounces cost nothing and   */
+/* don't toggle the LED or its supply. When the hold-off ends, a level  */
+/* left changed is taken as the edge and the pins follow the input.     */
+/************************************************************************/
+void input_interrupt(uint8_t input);
+
+uint16_t input_holdoff_ms[2];          // Left until the interrupt is unmasked, up to 256
+
+/* Called by the input's interrupt, after the edge */
+void input_holdoff(uint8_t input)
+{
+   const __flash input_t * in = &inputs[input];
+   
+   if (app_regs.REG_IN_HOLDOFF_MS[input] == 0)
+      return;
+   
+   *in->intmask &= ~in->pin;
+   
+   /* The pins were resynced to the input by the edge */
+   if (input_states[input].armed && input_states[input].action != INPUT_START)
+      in->dma->CTRLA = 0;
+   
+   /* The next 1 ms callback can be right away */
+   input_holdoff_ms[input] = app_regs.REG_IN_HOLDOFF_MS[input] + 1U;
+}
+
+/* Called by the 1 ms callback */
+void input_holdoff_timeout(void)
+{
+   const __flash input_t * in;
+   uint8_t sreg;
+   uint8_t i;
+   bool level, state;
+   
+   for (i = 0; i < 2; i++)
+   {
+      if (input_holdoff_ms[i] == 0 || --input_holdoff_ms[i])
+         continue;
+      
+      in = &inputs[i];
+      
+      sreg = SREG;
+      cli();
+      in->port->INTFLAGS = in->intflag;
+      
+      level = (in->port->IN & in->pin) ? true : false;
+      state = (app_regs.REG_IN_STATE & (i ? B_IN1 : B_IN0)) ? true : false;
+      SREG = sreg;
+      
+      /* Taken with the interrupts on and the pin still masked, it may start a new hold-off */
+      if (level != state)
+         input_interrupt(i);
+      
+      if (input_holdoff_ms[i])
+         continue;
+      
+      /* Unless the LED was started meanwhile */
+      if (input_states[i].armed && input_states[i].action != INPUT_START)
+         input_toggle(in, &input_states[i]);
+      
+      *in->intmask |= in->pin;
+   }
+}
+
+/************************************************************************/
+/* Input measurement                                                    */
+/*                                                                      */
+/* The interrupt of a measured input only stamps the edge and adds to   */
+/* the window's sums: rising edges, the first and last of them and the  */
+/* ticks spent high. When the window closes, the 1 ms callback turns    */
+/* them into the average period over the whole cycles, so the 32 us     */
+/* ticks only err once per window. The last rising edge opens the next  */
+/* window and no cycle is lost between them.                            */
+/************************************************************************/
+typedef struct
+{
+   uint32_t rising, edges;
+   uint32_t first, last;            // Ticks of the first and last rising edges
+   uint32_t high;                   // Ticks high of the pulses started from first
+   uint32_t last_high;              // Ticks high of the pulse started on last, once it ended
+   bool open;                       // The pulse started on last is still high
+} measure_t;
+
+measure_t measures[2];
+uint16_t measure_ms;
+
+/* Called by the input's interrupt */
+void measure_edge(uint8_t input)
+{
+   measure_t * measure = &measures[input];
+   uint32_t now;
+   
+   if (!(app_regs.REG_IN_MEASURE & (input ? B_IN1_MEASURE : B_IN0_MEASURE)))
+      return;
+   
+   now = input_events_now();
+   measure->edges++;
+   
+   if (inputs[input].port->IN & inputs[input].pin)
+   {
+      if (measure->rising++ == 0)
+         measure->first = now;
+      
+      measure->last = now;
+      measure->last_high = 0;
+      measure->open = true;
+   }
+   else if (measure->open)
+   {
+      measure->last_high = now - measure->last;
+      measure->high += measure->last_high;
+      measure->open = false;
+   }
+}
+
+void measure_reset(uint8_t input)
+{
+   uint8_t sreg = SREG;
+   
+   cli();
+   measures[input].rising = 0;
+   measures[input].edges = 0;
+   measures[input].high = 0;
+   measures[input].last_high = 0;
+   measures[input].open = false;
+   SREG = sreg;
+}
+
+void measure_close(uint8_t input, float * result)
+{
+   measure_t * measure = &measures[input];
+   measure_t window;
+   uint8_t sreg = SREG;
+   uint32_t span, high;
+   
+   cli();
+   window = *measure;
+   measure->rising = window.rising ? 1 : 0;
+   measure->edges = 0;
+   measure->first = window.last;
+   measure->high = window.open ? 0 : window.last_high;
+   SREG = sreg;
+   
+   result[0] = 0;
+   result[1] = 0;
+   result[2] = 0;
+   result[3] = window.edges;
+   
+   if (window.rising < 2)
+      return;
+   
+   /* The pulse started on the last rising edge belongs to the next window */
+   span = window.last - window.first;
+   high = window.high - (window.open ? 0 : window.last_high);
+   
+   /* Rising edges all on the same tick are too fast to measure */
+   if (span == 0)
+      return;
+   
+   result[0] = span * 32.0 / (window.rising - 1);
+   result[1] = 1000000.0 / result[0];
+   result[2] = high * 100.0 / span;
+}
+
+/* Called by the 1 ms callback */
+void measure_timeout(void)
+{
+   if (!app_regs.REG_IN_MEASURE)
+      return;
+   
+   if (++measure_ms < app_regs.REG_IN_MEASURE_WINDOW_MS)
+      return;
+   
+   measure_ms = 0;
+   
+   if (app_regs.REG_IN_MEASURE & B_IN0_MEASURE)
+   {
+      measure_close(0, app_regs.REG_IN0_MEASURE);
+      
+      if (app_regs.REG_EVNT_ENABLE & B_EVT_IN_MEASURE)
+         core_func_send_event(ADD_REG_IN0_MEASURE, true);
+   }
+   
+   if (app_regs.REG_IN_MEASURE & B_IN1_MEASURE)
+   {
+      measure_close(1, app_regs.REG_IN1_MEASURE);
+      
+      if (app_regs.REG_EVNT_ENABLE & B_EVT_IN_MEASURE)
+         core_func_send_event(ADD_REG_IN1_MEASURE, true);
+   }
+}
+
+
+/************************************************************************/
+/* REG_POWER_EN                                                         */
+/************************************************************************/
+void app_read_REG_POWER_EN(void)
+{
+	app_regs.REG_POWER_EN  = (read_LED0_PWR_ON) ? B_LED0_PWR_EN : 0;
+   app_regs.REG_POWER_EN |= (read_LED1_PWR_ON) ? B_LED1_PWR_EN : 0;
+}
+
+bool app_write_REG_POWER_EN(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
+   if (reg & B_LED0_PWR_EN)
+      set_LED0_PWR_ON;
+   
+   if (reg & B_LED0_PWR_DIS)
+      clr_LED0_PWR_ON;
+
+   if (reg & B_LED1_PWR_EN)
+      set_LED1_PWR_ON;
+
+   if (reg & B_LED1_PWR_DIS)
+      clr_LED1_PWR_ON;
+      
+   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_PWR_EN)
+      if (read_LED0_PWR_ON)
+         set_OUT0; else clr_OUT0;
+         
+   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_PWR_EN)
+      if (read_LED1_PWR_ON)
+         set_OUT1; else clr_OUT1;
+      
+   UPDATE_BOARD_LED0;
+   UPDATE_BOARD_LED1;
+
+   return true;
+}
+
+
+/************************************************************************/
+/* REG_LED_BEHAVING                                                     */
+/************************************************************************/
+void app_read_REG_LED_BEHAVING(void) {}
+bool app_write_REG_LED_BEHAVING(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+   
+   /* Stopping LED0 stops the complementary pair */
+   if ((reg & B_LED0_STOP) && led0_mode == MODE_LED0_COMPLEMENTARY && led1_mode == MODE_LED1_COMPLEMENTARY)
+      reg |= B_LED1_STOP;
+   
+   /* Both LEDs started by the same command are released together */
+   if ((reg & (B_LED0_START | B_LED1_START)) == (B_LED0_START | B_LED1_START))
+      sync_begin();
+
+	if (reg & B_LED0_START)
+   {
+      START_LED0_STOPWATCH;
+      
+      start_led0();
+      
+      /* Stops the stopwatch if nothing was started */
+      if (TCE0.CTRLA == TC_CLKSEL_DIV1_gc)
+         timer_type0_stop(&TCE0);
+   }
+   
+   if (reg & B_LED0_STOP)
+   {
+      if (TCC0_CTRLA)
+      {
+         clr_LED0_TRANSISTOR;
+      }
+
+      app_regs.REG_LED_BEHAVING = app_regs.REG_LED_BEHAVING & ~(B_LED0_START);
+      timer_type0_stop(&TCC0);
+      timer_type0_stop(&TCE0);
+      DMA.CH0.CTRLA = 0;
+      
+      /* The queue is dropped with the running protocol */
+      led0.queue.head = led0.queue.tail;
+      led0.queue.handover = false;
+      channel_rearm(&channels[0]);
+      
+      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_START)
+         clr_OUT0;
+         
+      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
+         clr_OUT0;
+      
+      UPDATE_BOARD_LED0;
+   }
+
+   if (reg & B_LED1_START)
+   {
+      START_LED1_STOPWATCH;
+      
+      start_led1();
+      
+      /* Stops the stopwatch if nothing was started */
+      if (TCD1.CTRLA == TC_CLKSEL_DIV1_gc)
+         timer_type1_stop(&TCD1);
+   }
+   
+   if (sync_hold)
+      sync_release();
+   
+   if (reg & B_LED1_STOP)
+   {
+      if (TCD0_CTRLA)
+      {
+         clr_LED1_TRANSISTOR;
+      }
+
+      app_regs.REG_LED_BEHAVING = app_regs.REG_LED_BEHAVING & ~(B_LED1_START);
+      timer_type0_stop(&TCD0);
+      timer_type1_stop(&TCD1);
+      DMA.CH1.CTRLA = 0;
+      
+      /* The queue is dropped with the running protocol */
+      led1.queue.head = led1.queue.tail;
+      led1.queue.handover = false;
+      channel_rearm(&channels[1]);
+      
+      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_START)
+         clr_OUT1;
+         
+      if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
+         clr_OUT1;
+      
+      UPDATE_BOARD_LED1;
+	}
+
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED_ON                                                           */
+/************************************************************************/
+void app_read_REG_LED_ON(void)
+{
+	app_regs.REG_LED_ON  = (read_LED0_TRANSISTOR) ? B_LED0_TO_ON : 0;
+   app_regs.REG_LED_ON |= (read_LED1_TRANSISTOR) ? B_LED1_TO_ON : 0;
+}
+
+bool app_write_REG_LED_ON(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+   
+   /* A start armed by an input holds the transistor's pin */
+   if (reg & (B_LED0_TO_ON | B_LED0_TO_OFF))
+      input_disarm_start(&channels[0]);
+   if (reg & (B_LED1_TO_ON | B_LED1_TO_OFF))
+      input_disarm_start(&channels[1]);
+   
+   if (reg & B_LED0_TO_ON)
+   {
+      set_LED0_TRANSISTOR;
+      UPDATE_BOARD_LED0;
+   }      
+   
+   if (reg & B_LED0_TO_OFF)
+   {
+      clr_LED0_TRANSISTOR;
+      UPDATE_BOARD_LED0;
+   }
+   
+   if (reg & B_LED1_TO_ON)
+   {
+      set_LED1_TRANSISTOR;
+      UPDATE_BOARD_LED1;
+   }      
+   
+   if (reg & B_LED1_TO_OFF)
+   {
+      clr_LED1_TRANSISTOR;
+      UPDATE_BOARD_LED1;
+   }
+   
+   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
+       if (read_LED0_TRANSISTOR)
+           set_OUT0; else clr_OUT0;
+           
+   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
+       if (read_LED1_TRANSISTOR)
+           set_OUT1; else clr_OUT1;
+   
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_IN_STATE                                                         */
+/************************************************************************/
+void app_read_REG_IN_STATE(void)
+{
+	app_regs.REG_IN_STATE  = (read_IN0) ? B_IN0 : 0;
+   app_regs.REG_IN_STATE |= (read_IN1) ? B_IN1 : 0;
+}
+
+bool app_write_REG_IN_STATE(void *a)
+{
+	return false;
+}
+
+
+/************************************************************************/
+/* REG_OUT_CONFIGURATION                                                */
+/************************************************************************/
+void app_read_REG_OUT_CONFIGURATION(void) {}
+bool app_write_REG_OUT_CONFIGURATION(void *a)
+{   
+    if (*((uint8_t*)a) & ~(MSK_OUT0_CONF | MSK_OUT1_CONF))
+        return false;
+    
+    app_regs.REG_OUT_CONFIGURATION = *((uint8_t*)a);
+
+   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_SOFTWARE)
+       if (app_regs.REG_OUT_STATE & B_OUT0_TO_HIGH)
+           set_OUT0; else clr_OUT0;           
+   
+   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_SOFTWARE)
+       if (app_regs.REG_OUT_STATE & B_OUT1_TO_HIGH)
+           set_OUT1; else clr_OUT1;
+       
+    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_PWR_EN)
+        if (read_LED0_PWR_ON)
+           set_OUT0; else clr_OUT0;
+       
+    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_PWR_EN)
+        if (read_LED1_PWR_ON)
+            set_OUT1; else clr_OUT1;
+       
+    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_START)
+        if (app_regs.REG_LED_BEHAVING & B_LED0_START)
+            set_OUT0; else clr_OUT0;
+            
+    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_START)
+        if (app_regs.REG_LED_BEHAVING & B_LED1_START)
+            set_OUT1; else clr_OUT1;
+       
+    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
+       if (read_LED0_TRANSISTOR)
+           set_OUT0; else clr_OUT0;
+           
+    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
+        if (read_LED1_TRANSISTOR)
+            set_OUT1; else clr_OUT1;
+       
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_IN_CONFIGURATION                                                 */
+/************************************************************************/
+void app_read_REG_IN_CONFIGURATION(void) {}
+bool app_write_REG_IN_CONFIGURATION(void *a)
+{
+	app_regs.REG_IN_CONFIGURATION = *((uint8_t*)a);
+	
+	inputs_configure();
+	
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED_CONFIGURATION                                                */
+/************************************************************************/
+void app_read_REG_LED_CONFIGURATION(void) {}
+bool app_write_REG_LED_CONFIGURATION(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+   
+   if (reg & ~(MSK_LED0_CONF | MSK_LED1_CONF))
+      return false;
+   
+   if ((reg & MSK_LED0_CONF) > GM_LED0_NESTED || (reg & MSK_LED1_CONF) > GM_LED1_NESTED)
+      return false;
+   
+   /* The complementary mode is configured on LED0 and drives both */
+   if ((reg & MSK_LED1_CONF) == (GM_LED0_COMPLEMENTARY << 4))
+      return false;
+
+	app_regs.REG_LED_CONFIGURATION = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_SUPPLY_PWR_CONF                                             */
+/************************************************************************/
+bool write_SMBus_word(uint8_t add, uint8_t reg, int16_t word);
+
+void app_read_REG_LED0_SUPPLY_PWR_CONF(void) {}
+bool app_write_REG_LED0_SUPPLY_PWR_CONF(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
+	if (reg < 1 || reg > 120)
+		return false;
+
+	if (!write_SMBus_word(17, 0x22, ((int16_t) reg) * 5 -300))
+		core_func_catastrophic_error_detected();
+
+	app_regs.REG_LED0_SUPPLY_PWR_CONF = reg;
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_SUPPLY_PWR_CONF                                             */
+/************************************************************************/
+extern bool bus_expansion_exists;
+
+void app_read_REG_LED1_SUPPLY_PWR_CONF(void) {}
+bool app_write_REG_LED1_SUPPLY_PWR_CONF(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
+	if (reg < 1 || reg > 120)
+		return false;	
+   
+	if (bus_expansion_exists == false)  // Check only if bus expansion exists in the bus
+		write_SMBus_word(33, 0x22, ((int16_t) reg) * 5 -300);
+		//   core_func_catastrophic_error_detected();
+
+	app_regs.REG_LED1_SUPPLY_PWR_CONF = reg;
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_PWM_FREQ                                                    */
+/************************************************************************/
+void app_read_REG_LED0_PWM_FREQ(void) {}
+bool app_write_REG_LED0_PWM_FREQ(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Check range */
+	if (reg < 0.01 || reg > 50000.0)
+		return false;
+
+	uint32_t period = PWM_FREQ_TO_PERIOD(reg);
+	uint32_t on = PWM_DCYCLE_TO_ON(app_regs.REG_LED0_PWM_DCYCLE, period);
+
+	if (!pwm_write(&TCC0, &led0.pwm, led0_mode, period, on))
+		return false;
+
+	app_regs.REG_LED0_PWM_PERIOD = period;
+	app_regs.REG_LED0_PWM_ON = on;
+
+	app_regs.REG_LED0_PWM_FREQ = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_PWM_DCYCLE                                                  */
+/************************************************************************/
+void app_read_REG_LED0_PWM_DCYCLE(void) {}
+bool app_write_REG_LED0_PWM_DCYCLE(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Check range */
+	if (reg < 0.1 || reg > 99.9)
+		return false;
+
+	uint32_t on = PWM_DCYCLE_TO_ON(reg, app_regs.REG_LED0_PWM_PERIOD);
+
+	if (!pwm_write(&TCC0, &led0.pwm, led0_mode, app_regs.REG_LED0_PWM_PERIOD, on))
+		return false;
+
+	app_regs.REG_LED0_PWM_ON = on;
+
+	app_regs.REG_LED0_PWM_DCYCLE = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_PWM_PULSES                                                  */
+/************************************************************************/
+void app_read_REG_LED0_PWM_PULSES(void) {}
+bool app_write_REG_LED0_PWM_PULSES(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED0_PWM_PULSES = reg;
+	app_regs.REG_LED0_PWM_PULSES_LONG = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_INTERVAL_ON                                                 */
+/************************************************************************/
+void app_read_REG_LED0_INTERVAL_ON(void) {}
+bool app_write_REG_LED0_INTERVAL_ON(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED0_INTERVAL_ON = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_INTERVAL_OFF                                                */
+/************************************************************************/
+void app_read_REG_LED0_INTERVAL_OFF(void) {}
+bool app_write_REG_LED0_INTERVAL_OFF(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED0_INTERVAL_OFF = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_INTERVAL_PULSES                                             */
+/************************************************************************/
+void app_read_REG_LED0_INTERVAL_PULSES(void) {}
+bool app_write_REG_LED0_INTERVAL_PULSES(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED0_INTERVAL_PULSES = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_INTERVAL_TAIL                                               */
+/************************************************************************/
+void app_read_REG_LED0_INTERVAL_TAIL(void) {}
+bool app_write_REG_LED0_INTERVAL_TAIL(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED0_INTERVAL_TAIL = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_INTERVAL_REPS                                               */
+/************************************************************************/
+void app_read_REG_LED0_INTERVAL_REPS(void) {}
+bool app_write_REG_LED0_INTERVAL_REPS(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED0_INTERVAL_REPS = reg;
+	app_regs.REG_LED0_INTERVAL_REPS_LONG = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_PWM_FREQ                                                    */
+/************************************************************************/
+void app_read_REG_LED1_PWM_FREQ(void) {}
+bool app_write_REG_LED1_PWM_FREQ(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Check range */
+	if (reg < 0.01 || reg > 50000.0)
+		return false;
+
+	uint32_t period = PWM_FREQ_TO_PERIOD(reg);
+	uint32_t on = PWM_DCYCLE_TO_ON(app_regs.REG_LED1_PWM_DCYCLE, period);
+
+	if (!pwm_write(&TCD0, &led1.pwm, led1_mode, period, on))
+		return false;
+
+	app_regs.REG_LED1_PWM_PERIOD = period;
+	app_regs.REG_LED1_PWM_ON = on;
+
+	app_regs.REG_LED1_PWM_FREQ = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_PWM_DCYCLE                                                  */
+/************************************************************************/
+void app_read_REG_LED1_PWM_DCYCLE(void) {}
+bool app_write_REG_LED1_PWM_DCYCLE(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Check range */
+	if (reg < 0.1 || reg > 99.9)
+		return false;
+
+	uint32_t on = PWM_DCYCLE_TO_ON(reg, app_regs.REG_LED1_PWM_PERIOD);
+
+	if (!pwm_write(&TCD0, &led1.pwm, led1_mode, app_regs.REG_LED1_PWM_PERIOD, on))
+		return false;
+
+	app_regs.REG_LED1_PWM_ON = on;
+
+	app_regs.REG_LED1_PWM_DCYCLE = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_PWM_PULSES                                                  */
+/************************************************************************/
+void app_read_REG_LED1_PWM_PULSES(void) {}
+bool app_write_REG_LED1_PWM_PULSES(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED1_PWM_PULSES = reg;
+	app_regs.REG_LED1_PWM_PULSES_LONG = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_INTERVAL_ON                                                 */
+/************************************************************************/
+void app_read_REG_LED1_INTERVAL_ON(void) {}
+bool app_write_REG_LED1_INTERVAL_ON(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+	
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED1_INTERVAL_ON = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_INTERVAL_OFF                                                */
+/************************************************************************/
+void app_read_REG_LED1_INTERVAL_OFF(void) {}
+bool app_write_REG_LED1_INTERVAL_OFF(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+		
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED1_INTERVAL_OFF = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_INTERVAL_PULSES                                             */
+/************************************************************************/
+void app_read_REG_LED1_INTERVAL_PULSES(void) {}
+bool app_write_REG_LED1_INTERVAL_PULSES(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+		
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED1_INTERVAL_PULSES = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_INTERVAL_TAIL                                               */
+/************************************************************************/
+void app_read_REG_LED1_INTERVAL_TAIL(void) {}
+bool app_write_REG_LED1_INTERVAL_TAIL(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+	
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;	
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED1_INTERVAL_TAIL = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_INTERVAL_REPS                                               */
+/************************************************************************/
+void app_read_REG_LED1_INTERVAL_REPS(void) {}
+bool app_write_REG_LED1_INTERVAL_REPS(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+	
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED1_INTERVAL_REPS = reg;
+	app_regs.REG_LED1_INTERVAL_REPS_LONG = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_PWM_FREQ_REAL                                               */
+/************************************************************************/
+void app_read_REG_LED0_PWM_FREQ_REAL(void)
+{
+	uint32_t period = pwm_period_real(&led0.pwm, led0_mode);
+	
+	app_regs.REG_LED0_PWM_FREQ_REAL = (period) ? PWM_PERIOD_TO_FREQ(period) : 0;
+}
+
+bool app_write_REG_LED0_PWM_FREQ_REAL(void *a)
+{
+   return false;
+}
+
+
+/************************************************************************/
+/* REG_LED0_PWM_DCYCLE_REAL                                             */
+/************************************************************************/
+void app_read_REG_LED0_PWM_DCYCLE_REAL(void)
+{
+	uint32_t period = pwm_period_real(&led0.pwm, led0_mode);
+	
+	app_regs.REG_LED0_PWM_DCYCLE_REAL = (period) ? PWM_ON_TO_DCYCLE(led0.pwm.on, period) : 0;
+}
+
+bool app_write_REG_LED0_PWM_DCYCLE_REAL(void *a)
+{
+   return false;
+}
+
+
+/************************************************************************/
+/* REG_LED1_PWM_FREQ_REAL                                               */
+/************************************************************************/
+void app_read_REG_LED1_PWM_FREQ_REAL(void)
+{
+	uint32_t period = pwm_period_real(&led1.pwm, led1_mode);
+	
+	app_regs.REG_LED1_PWM_FREQ_REAL = (period) ? PWM_PERIOD_TO_FREQ(period) : 0;
+}
+
+bool app_write_REG_LED1_PWM_FREQ_REAL(void *a)
+{
+   return false;
+}
+
+
+/************************************************************************/
+/* REG_LED1_PWM_DCYCLE_REAL                                             */
+/************************************************************************/
+void app_read_REG_LED1_PWM_DCYCLE_REAL(void)
+{
+	uint32_t period = pwm_period_real(&led1.pwm, led1_mode);
+	
+	app_regs.REG_LED1_PWM_DCYCLE_REAL = (period) ? PWM_ON_TO_DCYCLE(led1.pwm.on, period) : 0;
+}
+
+bool app_write_REG_LED1_PWM_DCYCLE_REAL(void *a)
+{
+   return false;
+}
+
+
+/************************************************************************/
+/* REG_AUX_DIG_OUT                                                      */
+/************************************************************************/
+void app_read_REG_AUX_DIG_OUT(void)
+{  
+   app_regs.REG_AUX_DIG_OUT  = (read_AUX0) ? B_AUX0_TO_HIGH : 0;
+   app_regs.REG_AUX_DIG_OUT |= (read_AUX1) ? B_AUX1_TO_HIGH : 0;
+}
+bool app_write_REG_AUX_DIG_OUT(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+   
+   if (reg & B_AUX0_TO_HIGH)
+      set_AUX0;
+   
+   if (reg & B_AUX0_TO_LOW)
+      clr_AUX0;
+   
+   if (reg & B_AUX1_TO_HIGH)
+      set_AUX1;
+   
+   if (reg & B_AUX1_TO_LOW)
+      clr_AUX1;
+      
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_AUX_SUPPLY_PWR_CONF                                              */
+/************************************************************************/
+void app_read_REG_AUX_SUPPLY_PWR_CONF(void) {}
+bool app_write_REG_AUX_SUPPLY_PWR_CONF(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+   
+   if (reg < 1 || reg > 120)
+		return false;	
+
+	write_SMBus_word(25, 0x22, ((int16_t) reg) * 5 -300);
+
+	app_regs.REG_AUX_SUPPLY_PWR_CONF = reg;
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_DUMMY0                                                           */
+/************************************************************************/
+void app_read_REG_OUT_STATE(void) {}
+bool app_write_REG_OUT_STATE(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+   
+   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_SOFTWARE)
+   {
+      if (reg & B_OUT0_TO_HIGH)
+         set_OUT0;
+      
+      if (reg & B_OUT0_TO_LOW)
+         clr_OUT0;
+   }
+   
+   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_SOFTWARE)
+   {
+      if (reg & B_OUT1_TO_HIGH)
+         set_OUT1;
+      
+      if (reg & B_OUT1_TO_LOW)
+         clr_OUT1;
+   }
+   
+   app_regs.REG_OUT_STATE = reg & 7;
+   
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_DUMMY1                                                           */
+/************************************************************************/
+void app_read_REG_DUMMY0(void) {}
+bool app_write_REG_DUMMY0(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+   
+   update_leds_on_box(reg);
+   
+	app_regs.REG_DUMMY0 = reg;
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_EVNT_ENABLE                                                      */
+/************************************************************************/
+void app_read_REG_EVNT_ENABLE(void)
+{
+	//app_regs.REG_EVNT_ENABLE = 0;
+
+}
+
+bool app_write_REG_EVNT_ENABLE(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
+	app_regs.REG_EVNT_ENABLE = reg;
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_SEGMENTS_INDEX                                              */
+/************************************************************************/
+void app_read_REG_LED0_SEGMENTS_INDEX(void) {}
+bool app_write_REG_LED0_SEGMENTS_INDEX(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
+	/* Check range */
+	if (reg > SEGMENTS_MAX - SEGMENTS_CHUNK)
+		return false;
+
+	app_regs.REG_LED0_SEGMENTS_INDEX = reg;
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_SEGMENTS                                                    */
+/************************************************************************/
+void app_read_REG_LED0_SEGMENTS(void)
+{
+	segments_read_chunk(&led0.segments, app_regs.REG_LED0_SEGMENTS_INDEX, app_regs.REG_LED0_SEGMENTS);
+}
+
+bool app_write_REG_LED0_SEGMENTS(void *a)
+{
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	if (!segments_write_chunk(&led0.segments, app_regs.REG_LED0_SEGMENTS_INDEX, (uint32_t*)a))
+		return false;
+
+	/* Next chunk goes right after this one */
+	segments_read_chunk(&led0.segments, app_regs.REG_LED0_SEGMENTS_INDEX, app_regs.REG_LED0_SEGMENTS);
+	app_regs.REG_LED0_SEGMENTS_INDEX += SEGMENTS_CHUNK;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_SEGMENTS_INDEX                                              */
+/************************************************************************/
+void app_read_REG_LED1_SEGMENTS_INDEX(void) {}
+bool app_write_REG_LED1_SEGMENTS_INDEX(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
+	/* Check range */
+	if (reg > SEGMENTS_MAX - SEGMENTS_CHUNK)
+		return false;
+
+	app_regs.REG_LED1_SEGMENTS_INDEX = reg;
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_SEGMENTS                                                    */
+/************************************************************************/
+void app_read_REG_LED1_SEGMENTS(void)
+{
+	segments_read_chunk(&led1.segments, app_regs.REG_LED1_SEGMENTS_INDEX, app_regs.REG_LED1_SEGMENTS);
+}
+
+bool app_write_REG_LED1_SEGMENTS(void *a)
+{
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	if (!segments_write_chunk(&led1.segments, app_regs.REG_LED1_SEGMENTS_INDEX, (uint32_t*)a))
+		return false;
+
+	/* Next chunk goes right after this one */
+	segments_read_chunk(&led1.segments, app_regs.REG_LED1_SEGMENTS_INDEX, app_regs.REG_LED1_SEGMENTS);
+	app_regs.REG_LED1_SEGMENTS_INDEX += SEGMENTS_CHUNK;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_CHIRP_FREQ_START                                            */
+/************************************************************************/
+void app_read_REG_LED0_CHIRP_FREQ_START(void) {}
+bool app_write_REG_LED0_CHIRP_FREQ_START(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 0.5 || reg > 2000.0)
+		return false;
+
+	app_regs.REG_LED0_CHIRP_FREQ_START = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_CHIRP_FREQ_END                                              */
+/************************************************************************/
+void app_read_REG_LED0_CHIRP_FREQ_END(void) {}
+bool app_write_REG_LED0_CHIRP_FREQ_END(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 0.5 || reg > 2000.0)
+		return false;
+
+	app_regs.REG_LED0_CHIRP_FREQ_END = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_CHIRP_PERIODS                                               */
+/************************************************************************/
+void app_read_REG_LED0_CHIRP_PERIODS(void) {}
+bool app_write_REG_LED0_CHIRP_PERIODS(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 2 || reg > CHIRP_MAX)
+		return false;
+
+	app_regs.REG_LED0_CHIRP_PERIODS = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_CHIRP_FREQ_START                                            */
+/************************************************************************/
+void app_read_REG_LED1_CHIRP_FREQ_START(void) {}
+bool app_write_REG_LED1_CHIRP_FREQ_START(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 0.5 || reg > 2000.0)
+		return false;
+
+	app_regs.REG_LED1_CHIRP_FREQ_START = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_CHIRP_FREQ_END                                              */
+/************************************************************************/
+void app_read_REG_LED1_CHIRP_FREQ_END(void) {}
+bool app_write_REG_LED1_CHIRP_FREQ_END(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 0.5 || reg > 2000.0)
+		return false;
+
+	app_regs.REG_LED1_CHIRP_FREQ_END = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_CHIRP_PERIODS                                               */
+/************************************************************************/
+void app_read_REG_LED1_CHIRP_PERIODS(void) {}
+bool app_write_REG_LED1_CHIRP_PERIODS(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 2 || reg > CHIRP_MAX)
+		return false;
+
+	app_regs.REG_LED1_CHIRP_PERIODS = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_INTERVAL_ON_US                                              */
+/************************************************************************/
+void app_read_REG_LED0_INTERVAL_ON_US(void) {}
+bool app_write_REG_LED0_INTERVAL_ON_US(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < INTERVAL_MIN_US || reg > INTERVAL_MAX_US)
+		return false;
+
+	app_regs.REG_LED0_INTERVAL_ON_US = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_INTERVAL_OFF_US                                             */
+/************************************************************************/
+void app_read_REG_LED0_INTERVAL_OFF_US(void) {}
+bool app_write_REG_LED0_INTERVAL_OFF_US(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < INTERVAL_MIN_US || reg > INTERVAL_MAX_US)
+		return false;
+
+	app_regs.REG_LED0_INTERVAL_OFF_US = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_INTERVAL_TAIL_US                                            */
+/************************************************************************/
+void app_read_REG_LED0_INTERVAL_TAIL_US(void) {}
+bool app_write_REG_LED0_INTERVAL_TAIL_US(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg > INTERVAL_TAIL_MAX_US)
+		return false;
+
+	app_regs.REG_LED0_INTERVAL_TAIL_US = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_INTERVAL_ON_US                                              */
+/************************************************************************/
+void app_read_REG_LED1_INTERVAL_ON_US(void) {}
+bool app_write_REG_LED1_INTERVAL_ON_US(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < INTERVAL_MIN_US || reg > INTERVAL_MAX_US)
+		return false;
+
+	app_regs.REG_LED1_INTERVAL_ON_US = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_INTERVAL_OFF_US                                             */
+/************************************************************************/
+void app_read_REG_LED1_INTERVAL_OFF_US(void) {}
+bool app_write_REG_LED1_INTERVAL_OFF_US(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < INTERVAL_MIN_US || reg > INTERVAL_MAX_US)
+		return false;
+
+	app_regs.REG_LED1_INTERVAL_OFF_US = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_INTERVAL_TAIL_US                                            */
+/************************************************************************/
+void app_read_REG_LED1_INTERVAL_TAIL_US(void) {}
+bool app_write_REG_LED1_INTERVAL_TAIL_US(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg > INTERVAL_TAIL_MAX_US)
+		return false;
+
+	app_regs.REG_LED1_INTERVAL_TAIL_US = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_START_LATENCY                                               */
+/************************************************************************/
+void app_read_REG_LED0_START_LATENCY(void) {}
+bool app_write_REG_LED0_START_LATENCY(void *a)
+{
+	return false;
+}
+
+
+/************************************************************************/
+/* REG_LED1_START_LATENCY                                               */
+/************************************************************************/
+void app_read_REG_LED1_START_LATENCY(void) {}
+bool app_write_REG_LED1_START_LATENCY(void *a)
+{
+	return false;
+}
+
+
+/************************************************************************/
+/* REG_LED_SYNC_OFFSET                                                  */
+/************************************************************************/
+void app_read_REG_LED_SYNC_OFFSET(void) {}
+bool app_write_REG_LED_SYNC_OFFSET(void *a)
+{
+	app_regs.REG_LED_SYNC_OFFSET = *((uint16_t*)a);
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED_SCHEDULE_SECOND                                              */
+/************************************************************************/
+void app_read_REG_LED_SCHEDULE_SECOND(void) {}
+bool app_write_REG_LED_SCHEDULE_SECOND(void *a)
+{
+	/* Return false if a start is pending */
+	if (app_regs.REG_LED_SCHEDULE)
+		return false;
+
+	app_regs.REG_LED_SCHEDULE_SECOND = *((uint32_t*)a);
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED_SCHEDULE_MICRO                                               */
+/************************************************************************/
+void app_read_REG_LED_SCHEDULE_MICRO(void) {}
+bool app_write_REG_LED_SCHEDULE_MICRO(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+
+	/* Return false if a start is pending */
+	if (app_regs.REG_LED_SCHEDULE)
+		return false;
+
+	/* Check range */
+	if (reg >= SCHEDULE_TICKS_PER_SECOND)
+		return false;
+
+	app_regs.REG_LED_SCHEDULE_MICRO = reg;
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED_SCHEDULE                                                     */
+/************************************************************************/
+void app_read_REG_LED_SCHEDULE(void) {}
+bool app_write_REG_LED_SCHEDULE(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	uint32_t second = app_regs.REG_LED_SCHEDULE_SECOND;
+	uint16_t tick = app_regs.REG_LED_SCHEDULE_MICRO;
+
+	if (reg & ~(B_LED0_START | B_LED1_START))
+		return false;
+
+	/* Any write cancels the pending start */
+	TCC1.INTCTRLB &= ~TC1_CCBINTLVL_gm;
+
+	/* LEDs already loaded are held and not shown, so they are stopped */
+	if (schedule_stage == SCHEDULE_RELEASE)
+	{
+		uint8_t stop = ((app_regs.REG_LED_SCHEDULE & B_LED0_START) ? B_LED0_STOP : 0) | ((app_regs.REG_LED_SCHEDULE & B_LED1_START) ? B_LED1_STOP : 0);
+		app_write_REG_LED_BEHAVING(&stop);
+	}
+
+	schedule_stage = SCHEDULE_IDLE;
+	app_regs.REG_LED_SCHEDULE = 0;
+
+	if (reg == 0)
+		return true;
+
+	/* The LEDs are loaded ahead of the scheduled time */
+	if (tick >= SCHEDULE_LEAD_TICKS)
+	{
+		tick -= SCHEDULE_LEAD_TICKS;
+	}
+	else
+	{
+		/* Return false if the lead would go before second 0 */
+		if (second == 0)
+			return false;
+
+		second--;
+		tick += SCHEDULE_TICKS_PER_SECOND - SCHEDULE_LEAD_TICKS;
+	}
+
+	/* Return false if there's no time left to load them */
+	if (second < core_func_read_R_TIMESTAMP_SECOND())
+		return false;
+	if (second == core_func_read_R_TIMESTAMP_SECOND() && tick <= TCC1.CNT)
+		return false;
+
+	schedule_second = second;
+	schedule_tick = tick;
+	schedule_stage = SCHEDULE_LOAD;
+	app_regs.REG_LED_SCHEDULE = reg;
+
+	schedule_compare();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_ENVELOPE_FREQ                                               */
+/************************************************************************/
+void app_read_REG_LED0_ENVELOPE_FREQ(void) {}
+bool app_write_REG_LED0_ENVELOPE_FREQ(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 0.1 || reg > 200.0)
+		return false;
+
+	app_regs.REG_LED0_ENVELOPE_FREQ = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_ENVELOPE_DEPTH                                              */
+/************************************************************************/
+void app_read_REG_LED0_ENVELOPE_DEPTH(void) {}
+bool app_write_REG_LED0_ENVELOPE_DEPTH(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 0.0 || reg > 100.0)
+		return false;
+
+	app_regs.REG_LED0_ENVELOPE_DEPTH = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_ENVELOPE_OFFSET                                             */
+/************************************************************************/
+void app_read_REG_LED0_ENVELOPE_OFFSET(void) {}
+bool app_write_REG_LED0_ENVELOPE_OFFSET(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 0.0 || reg > 100.0)
+		return false;
+
+	app_regs.REG_LED0_ENVELOPE_OFFSET = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_ENVELOPE_CYCLES                                             */
+/************************************************************************/
+void app_read_REG_LED0_ENVELOPE_CYCLES(void) {}
+bool app_write_REG_LED0_ENVELOPE_CYCLES(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED0_ENVELOPE_CYCLES = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_ENVELOPE_FREQ                                               */
+/************************************************************************/
+void app_read_REG_LED1_ENVELOPE_FREQ(void) {}
+bool app_write_REG_LED1_ENVELOPE_FREQ(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 0.1 || reg > 200.0)
+		return false;
+
+	app_regs.REG_LED1_ENVELOPE_FREQ = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_ENVELOPE_DEPTH                                              */
+/************************************************************************/
+void app_read_REG_LED1_ENVELOPE_DEPTH(void) {}
+bool app_write_REG_LED1_ENVELOPE_DEPTH(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 0.0 || reg > 100.0)
+		return false;
+
+	app_regs.REG_LED1_ENVELOPE_DEPTH = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_ENVELOPE_OFFSET                                             */
+/************************************************************************/
+void app_read_REG_LED1_ENVELOPE_OFFSET(void) {}
+bool app_write_REG_LED1_ENVELOPE_OFFSET(void *a)
+{
+	float reg = *((float*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 0.0 || reg > 100.0)
+		return false;
+
+	app_regs.REG_LED1_ENVELOPE_OFFSET = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_ENVELOPE_CYCLES                                             */
+/************************************************************************/
+void app_read_REG_LED1_ENVELOPE_CYCLES(void) {}
+bool app_write_REG_LED1_ENVELOPE_CYCLES(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
+
+	/* Check range */
+	if (reg < 1)
+		return false;
+
+	app_regs.REG_LED1_ENVELOPE_CYCLES = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED_ENVELOPE_SHAPE                                               */
+/************************************************************************/
+void app_read_REG_LED_ENVELOPE_SHAPE(void) {}
+bool app_write_REG_LED_ENVELOPE_SHAPE(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
+	if (reg & ~(MSK_LED0_SHAPE | MSK_LED1_SHAPE))
+		return false;
+
+	if ((reg & MSK_LED0_SHAPE) > GM_LED0_SHAPE_RAMP || (reg & MSK_LED1_SHAPE) > GM_LED1_SHAPE_RAMP)
+		return false;
+
+	app_regs.REG_LED_ENVELOPE_SHAPE = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_PWM_PERIOD                                                  */
+/************************************************************************/
+void app_read_REG_LED0_PWM_PERIOD(void) {}
+bool app_write_REG_LED0_PWM_PERIOD(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
+
+	if (!pwm_write(&TCC0, &led0.pwm, led0_mode, reg, app_regs.REG_LED0_PWM_ON))
+		return false;
+
+	app_regs.REG_LED0_PWM_PERIOD = reg;
+
+	/* The float registers follow, so a later frequency write keeps this duty cycle */
+	app_regs.REG_LED0_PWM_FREQ = PWM_PERIOD_TO_FREQ(app_regs.REG_LED0_PWM_PERIOD);
+	app_regs.REG_LED0_PWM_DCYCLE = PWM_ON_TO_DCYCLE(app_regs.REG_LED0_PWM_ON, app_regs.REG_LED0_PWM_PERIOD);
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_PWM_ON                                                      */
+/************************************************************************/
+void app_read_REG_LED0_PWM_ON(void) {}
+bool app_write_REG_LED0_PWM_ON(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
+
+	if (!pwm_write(&TCC0, &led0.pwm, led0_mode, app_regs.REG_LED0_PWM_PERIOD, reg))
+		return false;
+
+	app_regs.REG_LED0_PWM_ON = reg;
+
+	/* The float registers follow, so a later frequency write keeps this duty cycle */
+	app_regs.REG_LED0_PWM_FREQ = PWM_PERIOD_TO_FREQ(app_regs.REG_LED0_PWM_PERIOD);
+	app_regs.REG_LED0_PWM_DCYCLE = PWM_ON_TO_DCYCLE(app_regs.REG_LED0_PWM_ON, app_regs.REG_LED0_PWM_PERIOD);
+	inputs_reload();
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_IN_STATE                                                         */
+/* REG_LED1_PWM_PERIOD                                                  */
 /************************************************************************/
-void app_read_REG_IN_STATE(void)
+void app_read_REG_LED1_PWM_PERIOD(void) {}
+bool app_write_REG_LED1_PWM_PERIOD(void *a)
 {
-	app_regs.REG_IN_STATE  = (read_IN0) ? B_IN0 : 0;
-   app_regs.REG_IN_STATE |= (read_IN1) ? B_IN1 : 0;
-}
+	uint32_t reg = *((uint32_t*)a);
 
-bool app_write_REG_IN_STATE(void *a)
-{
-	return false;
+	if (!pwm_write(&TCD0, &led1.pwm, led1_mode, reg, app_regs.REG_LED1_PWM_ON))
+		return false;
+
+	app_regs.REG_LED1_PWM_PERIOD = reg;
+
+	/* The float registers follow, so a later frequency write keeps this duty cycle */
+	app_regs.REG_LED1_PWM_FREQ = PWM_PERIOD_TO_FREQ(app_regs.REG_LED1_PWM_PERIOD);
+	app_regs.REG_LED1_PWM_DCYCLE = PWM_ON_TO_DCYCLE(app_regs.REG_LED1_PWM_ON, app_regs.REG_LED1_PWM_PERIOD);
+	inputs_reload();
+	return true;
 }
 
 
 /************************************************************************/
-/* REG_OUT_CONFIGURATION                                                */
+/* REG_LED1_PWM_ON                                                      */
 /************************************************************************/
-void app_read_REG_OUT_CONFIGURATION(void) {}
-bool app_write_REG_OUT_CONFIGURATION(void *a)
-{   
-    if (*((uint8_t*)a) & ~(MSK_OUT0_CONF | MSK_OUT1_CONF))
-        return false;
-    
-    app_regs.REG_OUT_CONFIGURATION = *((uint8_t*)a);
+void app_read_REG_LED1_PWM_ON(void) {}
+bool app_write_REG_LED1_PWM_ON(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
 
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_SOFTWARE)
-       if (app_regs.REG_OUT_STATE & B_OUT0_TO_HIGH)
-           set_OUT0; else clr_OUT0;           
-   
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_SOFTWARE)
-       if (app_regs.REG_OUT_STATE & B_OUT1_TO_HIGH)
-           set_OUT1; else clr_OUT1;
-       
-    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_PWR_EN)
-        if (read_LED0_PWR_ON)
-           set_OUT0; else clr_OUT0;
-       
-    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_PWR_EN)
-        if (read_LED1_PWR_ON)
-            set_OUT1; else clr_OUT1;
-       
-    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_START)
-        if (app_regs.REG_LED_BEHAVING & B_LED0_START)
-            set_OUT0; else clr_OUT0;
-            
-    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_START)
-        if (app_regs.REG_LED_BEHAVING & B_LED1_START)
-            set_OUT1; else clr_OUT1;
-       
-    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_LED0_ON)
-       if (read_LED0_TRANSISTOR)
-           set_OUT0; else clr_OUT0;
-           
-    if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_LED1_ON)
-        if (read_LED1_TRANSISTOR)
-            set_OUT1; else clr_OUT1;
-       
+	if (!pwm_write(&TCD0, &led1.pwm, led1_mode, app_regs.REG_LED1_PWM_PERIOD, reg))
+		return false;
+
+	app_regs.REG_LED1_PWM_ON = reg;
+
+	/* The float registers follow, so a later frequency write keeps this duty cycle */
+	app_regs.REG_LED1_PWM_FREQ = PWM_PERIOD_TO_FREQ(app_regs.REG_LED1_PWM_PERIOD);
+	app_regs.REG_LED1_PWM_DCYCLE = PWM_ON_TO_DCYCLE(app_regs.REG_LED1_PWM_ON, app_regs.REG_LED1_PWM_PERIOD);
+	inputs_reload();
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_IN_CONFIGURATION                                                 */
+/* REG_LED0_QUEUE                                                       */
 /************************************************************************/
-void app_read_REG_IN_CONFIGURATION(void) {}
-bool app_write_REG_IN_CONFIGURATION(void *a)
+void app_read_REG_LED0_QUEUE(void) {}
+bool app_write_REG_LED0_QUEUE(void *a)
 {
-	app_regs.REG_IN_CONFIGURATION = *((uint8_t*)a);
+	uint32_t * reg = ((uint32_t*)a);
+
+	if (!queue_push(&led0.queue, reg))
+		return false;
+
+	for (uint8_t i = 0; i < 5; i++)
+		app_regs.REG_LED0_QUEUE[i] = reg[i];
+
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED_CONFIGURATION                                                */
+/* REG_LED0_QUEUE_COUNT                                                 */
 /************************************************************************/
-void app_read_REG_LED_CONFIGURATION(void) {}
-bool app_write_REG_LED_CONFIGURATION(void *a)
+void app_read_REG_LED0_QUEUE_COUNT(void)
+{
+	app_regs.REG_LED0_QUEUE_COUNT = led0.queue.tail - led0.queue.head;
+}
+
+bool app_write_REG_LED0_QUEUE_COUNT(void *a)
 {
 	uint8_t reg = *((uint8_t*)a);
-   
-   if (reg & ~(MSK_LED0_CONF | MSK_LED1_CONF))
-      return false;
 
-	app_regs.REG_LED_CONFIGURATION = reg;
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
+		return false;
+
+	/* Only clearing the queue is allowed */
+	if (reg)
+		return false;
+
+	led0.queue.head = led0.queue.tail;
+
+	app_regs.REG_LED0_QUEUE_COUNT = 0;
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED0_SUPPLY_PWR_CONF                                             */
+/* REG_LED1_QUEUE                                                       */
 /************************************************************************/
-bool write_SMBus_word(uint8_t add, uint8_t reg, int16_t word);
-
-void app_read_REG_LED0_SUPPLY_PWR_CONF(void) {}
-bool app_write_REG_LED0_SUPPLY_PWR_CONF(void *a)
+void app_read_REG_LED1_QUEUE(void) {}
+bool app_write_REG_LED1_QUEUE(void *a)
 {
-	uint8_t reg = *((uint8_t*)a);
+	uint32_t * reg = ((uint32_t*)a);
 
-	if (reg < 1 || reg > 120)
+	if (!queue_push(&led1.queue, reg))
 		return false;
 
-	if (!write_SMBus_word(17, 0x22, ((int16_t) reg) * 5 -300))
-		core_func_catastrophic_error_detected();
+	for (uint8_t i = 0; i < 5; i++)
+		app_regs.REG_LED1_QUEUE[i] = reg[i];
 
-	app_regs.REG_LED0_SUPPLY_PWR_CONF = reg;
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED1_SUPPLY_PWR_CONF                                             */
+/* REG_LED1_QUEUE_COUNT                                                 */
 /************************************************************************/
-extern bool bus_expansion_exists;
+void app_read_REG_LED1_QUEUE_COUNT(void)
+{
+	app_regs.REG_LED1_QUEUE_COUNT = led1.queue.tail - led1.queue.head;
+}
 
-void app_read_REG_LED1_SUPPLY_PWR_CONF(void) {}
-bool app_write_REG_LED1_SUPPLY_PWR_CONF(void *a)
+bool app_write_REG_LED1_QUEUE_COUNT(void *a)
 {
 	uint8_t reg = *((uint8_t*)a);
 
-	if (reg < 1 || reg > 120)
-		return false;	
-   
-	if (bus_expansion_exists == false)  // Check only if bus expansion exists in the bus
-		write_SMBus_word(33, 0x22, ((int16_t) reg) * 5 -300);
-		//   core_func_catastrophic_error_detected();
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
+		return false;
 
-	app_regs.REG_LED1_SUPPLY_PWR_CONF = reg;
+	/* Only clearing the queue is allowed */
+	if (reg)
+		return false;
+
+	led1.queue.head = led1.queue.tail;
+
+	app_regs.REG_LED1_QUEUE_COUNT = 0;
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED0_PWM_FREQ                                                    */
+/* REG_LED0_PWM_PULSES_LONG                                             */
 /************************************************************************/
-bool update_reals(float * real_freq, float * real_dcycle, float freq, float dcycle);
-
-void app_read_REG_LED0_PWM_FREQ(void) {}
-bool app_write_REG_LED0_PWM_FREQ(void *a)
+void app_read_REG_LED0_PWM_PULSES_LONG(void) {}
+bool app_write_REG_LED0_PWM_PULSES_LONG(void *a)
 {
-	float reg = *((float*)a);
-   
-   /* Return false if timer is running */
+	uint32_t reg = *((uint32_t*)a);
+
+	/* Return false if timer is running */
 	if (TCC0_CTRLA)
 		return false;
 
-	/* Check range */
-	if (reg < 0.5 || reg > 2000.0)
-		return false;
+	app_regs.REG_LED0_PWM_PULSES_LONG = reg;
+
+	/* The 16 bits register saturates, and is 0 while running until stopped */
+	app_regs.REG_LED0_PWM_PULSES = (reg > 0xFFFF) ? 0xFFFF : reg;
+	inputs_reload();
+	return true;
+}
+
 
-	float real_freq, real_dcycle;
+/************************************************************************/
+/* REG_LED0_INTERVAL_REPS_LONG                                          */
+/************************************************************************/
+void app_read_REG_LED0_INTERVAL_REPS_LONG(void) {}
+bool app_write_REG_LED0_INTERVAL_REPS_LONG(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
 
-	if (!update_reals(&real_freq, &real_dcycle, reg, app_regs.REG_LED0_PWM_DCYCLE))
+	/* Return false if timer is running */
+	if (TCC0_CTRLA)
 		return false;
 
-	app_regs.REG_LED0_PWM_FREQ_REAL = real_freq;
-	app_regs.REG_LED0_PWM_DCYCLE_REAL = real_dcycle;
+	app_regs.REG_LED0_INTERVAL_REPS_LONG = reg;
 
-	app_regs.REG_LED0_PWM_FREQ = reg;
+	/* The 16 bits register saturates, and is 0 while running until stopped */
+	app_regs.REG_LED0_INTERVAL_REPS = (reg > 0xFFFF) ? 0xFFFF : reg;
+	inputs_reload();
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED0_PWM_DCYCLE                                                  */
+/* REG_LED1_PWM_PULSES_LONG                                             */
 /************************************************************************/
-void app_read_REG_LED0_PWM_DCYCLE(void) {}
-bool app_write_REG_LED0_PWM_DCYCLE(void *a)
+void app_read_REG_LED1_PWM_PULSES_LONG(void) {}
+bool app_write_REG_LED1_PWM_PULSES_LONG(void *a)
 {
-	float reg = *((float*)a);
-   
-   /* Return false if timer is running */
-	if (TCC0_CTRLA)
+	uint32_t reg = *((uint32_t*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
 		return false;
 
-	/* Check range */
-	if (reg < 0.1 || reg > 99.9)
+	app_regs.REG_LED1_PWM_PULSES_LONG = reg;
+
+	/* The 16 bits register saturates, and is 0 while running until stopped */
+	app_regs.REG_LED1_PWM_PULSES = (reg > 0xFFFF) ? 0xFFFF : reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_INTERVAL_REPS_LONG                                          */
+/************************************************************************/
+void app_read_REG_LED1_INTERVAL_REPS_LONG(void) {}
+bool app_write_REG_LED1_INTERVAL_REPS_LONG(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
+
+	/* Return false if timer is running */
+	if (TCD0_CTRLA)
 		return false;
 
-	float real_freq, real_dcycle;
+	app_regs.REG_LED1_INTERVAL_REPS_LONG = reg;
+
+	/* The 16 bits register saturates, and is 0 while running until stopped */
+	app_regs.REG_LED1_INTERVAL_REPS = (reg > 0xFFFF) ? 0xFFFF : reg;
+	inputs_reload();
+	return true;
+}
+
 
-	if (!update_reals(&real_freq, &real_dcycle, app_regs.REG_LED0_PWM_FREQ, reg))
+/************************************************************************/
+/* REG_LED_JITTER                                                       */
+/************************************************************************/
+void app_read_REG_LED_JITTER(void) {}
+bool app_write_REG_LED_JITTER(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
+	if (reg & ~(MSK_LED0_JITTER | MSK_LED1_JITTER))
 		return false;
 
-	app_regs.REG_LED0_PWM_FREQ_REAL = real_freq;
-	app_regs.REG_LED0_PWM_DCYCLE_REAL = real_dcycle;   
+	if ((reg & MSK_LED0_JITTER) > GM_LED0_JITTER_EXPONENTIAL || (reg & MSK_LED1_JITTER) > GM_LED1_JITTER_EXPONENTIAL)
+		return false;
 
-	app_regs.REG_LED0_PWM_DCYCLE = reg;
+	app_regs.REG_LED_JITTER = reg;
+	inputs_reload();
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED0_PWM_PULSES                                                  */
+/* REG_LED0_JITTER_MIN_US                                               */
 /************************************************************************/
-void app_read_REG_LED0_PWM_PULSES(void) {}
-bool app_write_REG_LED0_PWM_PULSES(void *a)
+void app_read_REG_LED0_JITTER_MIN_US(void) {}
+bool app_write_REG_LED0_JITTER_MIN_US(void *a)
 {
-	uint16_t reg = *((uint16_t*)a);
+	uint32_t reg = *((uint32_t*)a);
 
 	/* Return false if timer is running */
 	if (TCC0_CTRLA)
 		return false;
 
 	/* Check range */
-	if (reg < 1)
+	if (reg < INTERVAL_MIN_US || reg > INTERVAL_MAX_US)
 		return false;
 
-	app_regs.REG_LED0_PWM_PULSES = reg;
+	app_regs.REG_LED0_JITTER_MIN_US = reg;
+	inputs_reload();
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED0_INTERVAL_ON                                                 */
+/* REG_LED0_JITTER_MAX_US                                               */
 /************************************************************************/
-void app_read_REG_LED0_INTERVAL_ON(void) {}
-bool app_write_REG_LED0_INTERVAL_ON(void *a)
+void app_read_REG_LED0_JITTER_MAX_US(void) {}
+bool app_write_REG_LED0_JITTER_MAX_US(void *a)
 {
-	uint16_t reg = *((uint16_t*)a);
+	uint32_t reg = *((uint32_t*)a);
 
 	/* Return false if timer is running */
 	if (TCC0_CTRLA)
 		return false;
 
 	/* Check range */
-	if (reg < 1)
+	if (reg < INTERVAL_MIN_US || reg > INTERVAL_MAX_US)
 		return false;
 
-	app_regs.REG_LED0_INTERVAL_ON = reg;
+	app_regs.REG_LED0_JITTER_MAX_US = reg;
+	inputs_reload();
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED0_INTERVAL_OFF                                                */
+/* REG_LED0_JITTER_SEED                                                 */
 /************************************************************************/
-void app_read_REG_LED0_INTERVAL_OFF(void) {}
-bool app_write_REG_LED0_INTERVAL_OFF(void *a)
+void app_read_REG_LED0_JITTER_SEED(void) {}
+bool app_write_REG_LED0_JITTER_SEED(void *a)
 {
-	uint16_t reg = *((uint16_t*)a);
+	uint32_t reg = *((uint32_t*)a);
+
+	/* Xorshift never leaves the zero state */
+	if (reg == 0)
+		return false;
+
+	app_regs.REG_LED0_JITTER_SEED = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_JITTER_OFF_US                                               */
+/************************************************************************/
+void app_read_REG_LED0_JITTER_OFF_US(void) {}
+bool app_write_REG_LED0_JITTER_OFF_US(void *a)
+{
+	return false;
+}
+
+
+/************************************************************************/
+/* REG_LED1_JITTER_MIN_US                                               */
+/************************************************************************/
+void app_read_REG_LED1_JITTER_MIN_US(void) {}
+bool app_write_REG_LED1_JITTER_MIN_US(void *a)
+{
+	uint32_t reg = *((uint32_t*)a);
 
 	/* Return false if timer is running */
-	if (TCC0_CTRLA)
+	if (TCD0_CTRLA)
 		return false;
 
 	/* Check range */
-	if (reg < 1)
+	if (reg < INTERVAL_MIN_US || reg > INTERVAL_MAX_US)
 		return false;
 
-	app_regs.REG_LED0_INTERVAL_OFF = reg;
+	app_regs.REG_LED1_JITTER_MIN_US = reg;
+	inputs_reload();
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED0_INTERVAL_PULSES                                             */
+/* REG_LED1_JITTER_MAX_US                                               */
 /************************************************************************/
-void app_read_REG_LED0_INTERVAL_PULSES(void) {}
-bool app_write_REG_LED0_INTERVAL_PULSES(void *a)
+void app_read_REG_LED1_JITTER_MAX_US(void) {}
+bool app_write_REG_LED1_JITTER_MAX_US(void *a)
 {
-	uint16_t reg = *((uint16_t*)a);
+	uint32_t reg = *((uint32_t*)a);
 
 	/* Return false if timer is running */
-	if (TCC0_CTRLA)
+	if (TCD0_CTRLA)
 		return false;
 
 	/* Check range */
-	if (reg < 1)
+	if (reg < INTERVAL_MIN_US || reg > INTERVAL_MAX_US)
 		return false;
 
-	app_regs.REG_LED0_INTERVAL_PULSES = reg;
+	app_regs.REG_LED1_JITTER_MAX_US = reg;
+	inputs_reload();
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED0_INTERVAL_TAIL                                               */
+/* REG_LED1_JITTER_SEED                                                 */
 /************************************************************************/
-void app_read_REG_LED0_INTERVAL_TAIL(void) {}
-bool app_write_REG_LED0_INTERVAL_TAIL(void *a)
+void app_read_REG_LED1_JITTER_SEED(void) {}
+bool app_write_REG_LED1_JITTER_SEED(void *a)
 {
-	uint16_t reg = *((uint16_t*)a);
+	uint32_t reg = *((uint32_t*)a);
 
-	/* Return false if timer is running */
-	if (TCC0_CTRLA)
+	/* Xorshift never leaves the zero state */
+	if (reg == 0)
 		return false;
 
+	app_regs.REG_LED1_JITTER_SEED = reg;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED1_JITTER_OFF_US                                               */
+/************************************************************************/
+void app_read_REG_LED1_JITTER_OFF_US(void) {}
+bool app_write_REG_LED1_JITTER_OFF_US(void *a)
+{
+	return false;
+}
+
+
+/************************************************************************/
+/* REG_LED0_PROGRAM_INDEX                                               */
+/************************************************************************/
+void app_read_REG_LED0_PROGRAM_INDEX(void) {}
+bool app_write_REG_LED0_PROGRAM_INDEX(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
 	/* Check range */
-	if (reg < 1)
+	if (reg > PROGRAM_MAX - PROGRAM_CHUNK)
 		return false;
 
-	app_regs.REG_LED0_INTERVAL_TAIL = reg;
+	app_regs.REG_LED0_PROGRAM_INDEX = reg;
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED0_INTERVAL_REPS                                               */
+/* REG_LED0_PROGRAM                                                     */
 /************************************************************************/
-void app_read_REG_LED0_INTERVAL_REPS(void) {}
-bool app_write_REG_LED0_INTERVAL_REPS(void *a)
+void app_read_REG_LED0_PROGRAM(void)
 {
-	uint16_t reg = *((uint16_t*)a);
+	program_read_chunk(&led0.program, app_regs.REG_LED0_PROGRAM_INDEX, app_regs.REG_LED0_PROGRAM);
+}
 
+bool app_write_REG_LED0_PROGRAM(void *a)
+{
 	/* Return false if timer is running */
 	if (TCC0_CTRLA)
 		return false;
 
+	if (!program_write_chunk(&led0.program, app_regs.REG_LED0_PROGRAM_INDEX, (uint32_t*)a))
+		return false;
+
+	/* Next chunk goes right after this one */
+	program_read_chunk(&led0.program, app_regs.REG_LED0_PROGRAM_INDEX, app_regs.REG_LED0_PROGRAM);
+	app_regs.REG_LED0_PROGRAM_INDEX += PROGRAM_CHUNK;
+	inputs_reload();
+	return true;
+}
+
+
+/************************************************************************/
+/* REG_LED0_PROGRAM_EVENT                                               */
+/************************************************************************/
+void app_read_REG_LED0_PROGRAM_EVENT(void) {}
+bool app_write_REG_LED0_PROGRAM_EVENT(void *a)
+{
+	return false;
+}
+
+
+/************************************************************************/
+/* REG_LED1_PROGRAM_INDEX                                               */
+/************************************************************************/
+void app_read_REG_LED1_PROGRAM_INDEX(void) {}
+bool app_write_REG_LED1_PROGRAM_INDEX(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+
 	/* Check range */
-	if (reg < 1)
+	if (reg > PROGRAM_MAX - PROGRAM_CHUNK)
 		return false;
 
-	app_regs.REG_LED0_INTERVAL_REPS = reg;
+	app_regs.REG_LED1_PROGRAM_INDEX = reg;
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED1_PWM_FREQ                                                    */
+/* REG_LED1_PROGRAM                                                     */
 /************************************************************************/
-void app_read_REG_LED1_PWM_FREQ(void) {}
-bool app_write_REG_LED1_PWM_FREQ(void *a)
+void app_read_REG_LED1_PROGRAM(void)
 {
-	float reg = *((float*)a);
+	program_read_chunk(&led1.program, app_regs.REG_LED1_PROGRAM_INDEX, app_regs.REG_LED1_PROGRAM);
+}
 
+bool app_write_REG_LED1_PROGRAM(void *a)
+{
 	/* Return false if timer is running */
 	if (TCD0_CTRLA)
 		return false;
 
-	/* Check range */
-	if (reg < 0.5 || reg > 2000.0)
-		return false;
-
-	float real_freq, real_dcycle;
-
-	if (!update_reals(&real_freq, &real_dcycle, reg, app_regs.REG_LED1_PWM_DCYCLE))
+	if (!program_write_chunk(&led1.program, app_regs.REG_LED1_PROGRAM_INDEX, (uint32_t*)a))
 		return false;
 
-	app_regs.REG_LED1_PWM_FREQ_REAL = real_freq;
-	app_regs.REG_LED1_PWM_DCYCLE_REAL = real_dcycle;
-
-	app_regs.REG_LED1_PWM_FREQ = reg;
+	/* Next chunk goes right after this one */
+	program_read_chunk(&led1.program, app_regs.REG_LED1_PROGRAM_INDEX, app_regs.REG_LED1_PROGRAM);
+	app_regs.REG_LED1_PROGRAM_INDEX += PROGRAM_CHUNK;
+	inputs_reload();
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED1_PWM_DCYCLE                                                  */
+/* REG_LED1_PROGRAM_EVENT                                               */
 /************************************************************************/
-void app_read_REG_LED1_PWM_DCYCLE(void) {}
-bool app_write_REG_LED1_PWM_DCYCLE(void *a)
+void app_read_REG_LED1_PROGRAM_EVENT(void) {}
+bool app_write_REG_LED1_PROGRAM_EVENT(void *a)
 {
-	float reg = *((float*)a);
-	
-	/* Return false if timer is running */
-	if (TCD0_CTRLA)
-		return false;
-
-	/* Check range */
-	if (reg < 0.1 || reg > 99.9)
-		return false;
-
-	float real_freq, real_dcycle;
-
-	if (!update_reals(&real_freq, &real_dcycle, app_regs.REG_LED1_PWM_FREQ, reg))
-		return false;
+	return false;
+}
 
-	app_regs.REG_LED1_PWM_FREQ_REAL = real_freq;
-	app_regs.REG_LED1_PWM_DCYCLE_REAL = real_dcycle;
 
-	app_regs.REG_LED1_PWM_DCYCLE = reg;
+/************************************************************************/
+/* REG_LED_DEAD_TIME                                                    */
+/************************************************************************/
+void app_read_REG_LED_DEAD_TIME(void) {}
+bool app_write_REG_LED_DEAD_TIME(void *a)
+{
+	/* Taken on the next start, since both LEDs are loaded together */
+	app_regs.REG_LED_DEAD_TIME = *((uint16_t*)a);
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED1_PWM_PULSES                                                  */
+/* REG_LED0_NEST                                                        */
 /************************************************************************/
-void app_read_REG_LED1_PWM_PULSES(void) {}
-bool app_write_REG_LED1_PWM_PULSES(void *a)
+void app_read_REG_LED0_NEST(void) {}
+bool app_write_REG_LED0_NEST(void *a)
 {
-	uint16_t reg = *((uint16_t*)a);
+	uint32_t * reg = ((uint32_t*)a);
+	uint32_t gaps = 0;
 
 	/* Return false if timer is running */
-	if (TCD0_CTRLA)
+	if (TCC0_CTRLA)
 		return false;
 
 	/* Check range */
-	if (reg < 1)
+	if (reg[0] < INTERVAL_MIN_US || reg[0] > INTERVAL_MAX_US || reg[1] < INTERVAL_MIN_US || reg[1] > INTERVAL_MAX_US)
 		return false;
 
-	app_regs.REG_LED1_PWM_PULSES = reg;
+	/* The gaps of all levels can end on the same pulse */
+	for (uint8_t i = 0; i < NEST_LEVELS; i++)
+	{
+		if (reg[3 + 2 * i] > INTERVAL_TAIL_MAX_US - gaps)
+			return false;
+		gaps += reg[3 + 2 * i];
+	}
+
+	for (uint8_t i = 0; i < 2 + 2 * NEST_LEVELS; i++)
+		app_regs.REG_LED0_NEST[i] = reg[i];
+
+	inputs_reload();
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED1_INTERVAL_ON                                                 */
+/* REG_LED1_NEST                                                        */
 /************************************************************************/
-void app_read_REG_LED1_INTERVAL_ON(void) {}
-bool app_write_REG_LED1_INTERVAL_ON(void *a)
+void app_read_REG_LED1_NEST(void) {}
+bool app_write_REG_LED1_NEST(void *a)
 {
-	uint16_t reg = *((uint16_t*)a);
-	
+	uint32_t * reg = ((uint32_t*)a);
+	uint32_t gaps = 0;
+
 	/* Return false if timer is running */
 	if (TCD0_CTRLA)
 		return false;
 
 	/* Check range */
-	if (reg < 1)
+	if (reg[0] < INTERVAL_MIN_US || reg[0] > INTERVAL_MAX_US || reg[1] < INTERVAL_MIN_US || reg[1] > INTERVAL_MAX_US)
 		return false;
 
-	app_regs.REG_LED1_INTERVAL_ON = reg;
+	/* The gaps of all levels can end on the same pulse */
+	for (uint8_t i = 0; i < NEST_LEVELS; i++)
+	{
+		if (reg[3 + 2 * i] > INTERVAL_TAIL_MAX_US - gaps)
+			return false;
+		gaps += reg[3 + 2 * i];
+	}
+
+	for (uint8_t i = 0; i < 2 + 2 * NEST_LEVELS; i++)
+		app_regs.REG_LED1_NEST[i] = reg[i];
+
+	inputs_reload();
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED1_INTERVAL_OFF                                                */
+/* REG_LED0_PROGRESS                                                    */
 /************************************************************************/
-void app_read_REG_LED1_INTERVAL_OFF(void) {}
-bool app_write_REG_LED1_INTERVAL_OFF(void *a)
+void app_read_REG_LED0_PROGRESS(void)
 {
-	uint16_t reg = *((uint16_t*)a);
-		
-	/* Return false if timer is running */
-	if (TCD0_CTRLA)
-		return false;
-
-	/* Check range */
-	if (reg < 1)
-		return false;
+	progress_read(&channels[0], app_regs.REG_LED0_PROGRESS);
+}
 
-	app_regs.REG_LED1_INTERVAL_OFF = reg;
-	return true;
+bool app_write_REG_LED0_PROGRESS(void *a)
+{
+	return false;
 }
 
 
 /************************************************************************/
-/* REG_LED1_INTERVAL_PULSES                                             */
+/* REG_LED1_PROGRESS                                                    */
 /************************************************************************/
-void app_read_REG_LED1_INTERVAL_PULSES(void) {}
-bool app_write_REG_LED1_INTERVAL_PULSES(void *a)
+void app_read_REG_LED1_PROGRESS(void)
 {
-	uint16_t reg = *((uint16_t*)a);
-		
-	/* Return false if timer is running */
-	if (TCD0_CTRLA)
-		return false;
-
-	/* Check range */
-	if (reg < 1)
-		return false;
+	progress_read(&channels[1], app_regs.REG_LED1_PROGRESS);
+}
 
-	app_regs.REG_LED1_INTERVAL_PULSES = reg;
-	return true;
+bool app_write_REG_LED1_PROGRESS(void *a)
+{
+	return false;
 }
 
 
 /************************************************************************/
-/* REG_LED1_INTERVAL_TAIL                                               */
+/* REG_IN_CAPTURE                                                       */
 /************************************************************************/
-void app_read_REG_LED1_INTERVAL_TAIL(void) {}
-bool app_write_REG_LED1_INTERVAL_TAIL(void *a)
+void app_read_REG_IN_CAPTURE(void) {}
+bool app_write_REG_IN_CAPTURE(void *a)
 {
-	uint16_t reg = *((uint16_t*)a);
+	uint8_t reg = *((uint8_t*)a);
 	
-	/* Return false if timer is running */
-	if (TCD0_CTRLA)
-		return false;	
-
-	/* Check range */
-	if (reg < 1)
+	if (reg & ~(B_IN0_CAPTURE | B_IN1_CAPTURE))
 		return false;
-
-	app_regs.REG_LED1_INTERVAL_TAIL = reg;
+	
+	/* The edges captured so far are not held back */
+	capture_send();
+	
+	app_regs.REG_IN_CAPTURE = reg;
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED1_INTERVAL_REPS                                               */
+/* REG_IN_CAPTURE_EDGES                                                 */
 /************************************************************************/
-void app_read_REG_LED1_INTERVAL_REPS(void) {}
-bool app_write_REG_LED1_INTERVAL_REPS(void *a)
+void app_read_REG_IN_CAPTURE_EDGES(void) {}
+bool app_write_REG_IN_CAPTURE_EDGES(void *a)
 {
-	uint16_t reg = *((uint16_t*)a);
+	uint8_t reg = *((uint8_t*)a);
 	
-	/* Return false if timer is running */
-	if (TCD0_CTRLA)
+	if (reg < 1 || reg > CAPTURE_EDGES)
 		return false;
+	
+	if (capture_count >= reg)
+		capture_send();
+	
+	app_regs.REG_IN_CAPTURE_EDGES = reg;
+	return true;
+}
 
-	/* Check range */
-	if (reg < 1)
-		return false;
 
-	app_regs.REG_LED1_INTERVAL_REPS = reg;
+/************************************************************************/
+/* REG_IN_CAPTURE_PERIOD                                                */
+/************************************************************************/
+void app_read_REG_IN_CAPTURE_PERIOD(void) {}
+bool app_write_REG_IN_CAPTURE_PERIOD(void *a)
+{
+	app_regs.REG_IN_CAPTURE_PERIOD = *((uint16_t*)a);
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED0_PWM_FREQ_REAL                                               */
+/* REG_IN_CAPTURE_EVENT                                                 */
 /************************************************************************/
-void app_read_REG_LED0_PWM_FREQ_REAL(void) {}
-bool app_write_REG_LED0_PWM_FREQ_REAL(void *a)
+void app_read_REG_IN_CAPTURE_EVENT(void) {}
+bool app_write_REG_IN_CAPTURE_EVENT(void *a)
 {
-   return false;
+	return false;
 }
 
 
 /************************************************************************/
-/* REG_LED0_PWM_DCYCLE_REAL                                             */
+/* REG_IN_EVENT_CONF                                                    */
 /************************************************************************/
-void app_read_REG_LED0_PWM_DCYCLE_REAL(void) {}
-bool app_write_REG_LED0_PWM_DCYCLE_REAL(void *a)
+void app_read_REG_IN_EVENT_CONF(void) {}
+bool app_write_REG_IN_EVENT_CONF(void *a)
 {
-   return false;
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (reg & ~(MSK_IN0_EVENT | MSK_IN1_EVENT))
+		return false;
+	if ((reg & MSK_IN0_EVENT) > GM_IN0_EVENT_RATE || (reg & MSK_IN1_EVENT) > GM_IN1_EVENT_RATE)
+		return false;
+	
+	app_regs.REG_IN_EVENT_CONF = reg;
+	input_events_reset();
+	
+	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED1_PWM_FREQ_REAL                                               */
+/* REG_IN_EVENT_NTH                                                     */
 /************************************************************************/
-void app_read_REG_LED1_PWM_FREQ_REAL(void) {}
-bool app_write_REG_LED1_PWM_FREQ_REAL(void *a)
+void app_read_REG_IN_EVENT_NTH(void) {}
+bool app_write_REG_IN_EVENT_NTH(void *a)
 {
-   return false;
+	uint16_t * reg = ((uint16_t*)a);
+	
+	if (reg[0] < 1 || reg[1] < 1)
+		return false;
+	
+	app_regs.REG_IN_EVENT_NTH[0] = reg[0];
+	app_regs.REG_IN_EVENT_NTH[1] = reg[1];
+	input_events_reset();
+	
+	return true;
 }
 
 
 /************************************************************************/
-/* REG_LED1_PWM_DCYCLE_REAL                                             */
+/* REG_IN_EVENT_PERIOD_US                                               */
 /************************************************************************/
-void app_read_REG_LED1_PWM_DCYCLE_REAL(void) {}
-bool app_write_REG_LED1_PWM_DCYCLE_REAL(void *a)
+void app_read_REG_IN_EVENT_PERIOD_US(void) {}
+bool app_write_REG_IN_EVENT_PERIOD_US(void *a)
 {
-   return false;
+	uint32_t * reg = ((uint32_t*)a);
+	
+	for (uint8_t i = 0; i < 2; i++)
+		if (reg[i] < 32 || reg[i] > 100000000)
+			return false;
+	
+	app_regs.REG_IN_EVENT_PERIOD_US[0] = reg[0];
+	app_regs.REG_IN_EVENT_PERIOD_US[1] = reg[1];
+	
+	return true;
 }
 
 
 /************************************************************************/
-/* REG_AUX_DIG_OUT                                                      */
+/* REG_IN_EDGES                                                         */
 /************************************************************************/
-void app_read_REG_AUX_DIG_OUT(void)
-{  
-   app_regs.REG_AUX_DIG_OUT  = (read_AUX0) ? B_AUX0_TO_HIGH : 0;
-   app_regs.REG_AUX_DIG_OUT |= (read_AUX1) ? B_AUX1_TO_HIGH : 0;
-}
-bool app_write_REG_AUX_DIG_OUT(void *a)
+void app_read_REG_IN_EDGES(void) {}
+bool app_write_REG_IN_EDGES(void *a)
 {
-	uint8_t reg = *((uint8_t*)a);
-   
-   if (reg & B_AUX0_TO_HIGH)
-      set_AUX0;
-   
-   if (reg & B_AUX0_TO_LOW)
-      clr_AUX0;
-   
-   if (reg & B_AUX1_TO_HIGH)
-      set_AUX1;
-   
-   if (reg & B_AUX1_TO_LOW)
-      clr_AUX1;
-      
+	uint16_t * reg = ((uint16_t*)a);
+	
+	app_regs.REG_IN_EDGES[0] = reg[0];
+	app_regs.REG_IN_EDGES[1] = reg[1];
+	
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_AUX_SUPPLY_PWR_CONF                                              */
+/* REG_IN_FILTER_SAMPLES                                                */
 /************************************************************************/
-void app_read_REG_AUX_SUPPLY_PWR_CONF(void) {}
-bool app_write_REG_AUX_SUPPLY_PWR_CONF(void *a)
+void app_read_REG_IN_FILTER_SAMPLES(void) {}
+bool app_write_REG_IN_FILTER_SAMPLES(void *a)
 {
-	uint8_t reg = *((uint8_t*)a);
-   
-   if (reg < 1 || reg > 120)
-		return false;	
+	uint8_t * reg = ((uint8_t*)a);
+	
+	for (uint8_t i = 0; i < 2; i++)
+		if (reg[i] < 1 || reg[i] > 8)
+			return false;
+	
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		app_regs.REG_IN_FILTER_SAMPLES[i] = reg[i];
+		*inputs[i].evctrl = reg[i] - 1;
+	}
+	
+	return true;
+}
 
-	write_SMBus_word(25, 0x22, ((int16_t) reg) * 5 -300);
 
-	app_regs.REG_AUX_SUPPLY_PWR_CONF = reg;
+/************************************************************************/
+/* REG_IN_HOLDOFF_MS                                                    */
+/************************************************************************/
+void app_read_REG_IN_HOLDOFF_MS(void) {}
+bool app_write_REG_IN_HOLDOFF_MS(void *a)
+{
+	uint8_t * reg = ((uint8_t*)a);
+	
+	app_regs.REG_IN_HOLDOFF_MS[0] = reg[0];
+	app_regs.REG_IN_HOLDOFF_MS[1] = reg[1];
+	
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_DUMMY0                                                           */
+/* REG_IN_MEASURE                                                       */
 /************************************************************************/
-void app_read_REG_OUT_STATE(void) {}
-bool app_write_REG_OUT_STATE(void *a)
+void app_read_REG_IN_MEASURE(void) {}
+bool app_write_REG_IN_MEASURE(void *a)
 {
 	uint8_t reg = *((uint8_t*)a);
-   
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT0_CONF) == GM_OUT0_SOFTWARE)
-   {
-      if (reg & B_OUT0_TO_HIGH)
-         set_OUT0;
-      
-      if (reg & B_OUT0_TO_LOW)
-         clr_OUT0;
-   }
-   
-   if ((app_regs.REG_OUT_CONFIGURATION & MSK_OUT1_CONF) == GM_OUT1_SOFTWARE)
-   {
-      if (reg & B_OUT1_TO_HIGH)
-         set_OUT1;
-      
-      if (reg & B_OUT1_TO_LOW)
-         clr_OUT1;
-   }
-   
-   app_regs.REG_OUT_STATE = reg & 7;
-   
+	
+	if (reg & ~(B_IN0_MEASURE | B_IN1_MEASURE))
+		return false;
+	
+	/* Inputs turned on start with an empty window */
+	if ((reg & B_IN0_MEASURE) && !(app_regs.REG_IN_MEASURE & B_IN0_MEASURE))
+		measure_reset(0);
+	if ((reg & B_IN1_MEASURE) && !(app_regs.REG_IN_MEASURE & B_IN1_MEASURE))
+		measure_reset(1);
+	
+	if (!app_regs.REG_IN_MEASURE)
+		measure_ms = 0;
+	
+	app_regs.REG_IN_MEASURE = reg;
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_DUMMY1                                                           */
+/* REG_IN_MEASURE_WINDOW_MS                                             */
 /************************************************************************/
-void app_read_REG_DUMMY0(void) {}
-bool app_write_REG_DUMMY0(void *a)
+void app_read_REG_IN_MEASURE_WINDOW_MS(void) {}
+bool app_write_REG_IN_MEASURE_WINDOW_MS(void *a)
 {
-	uint8_t reg = *((uint8_t*)a);
-   
-   update_leds_on_box(reg);
-   
-	app_regs.REG_DUMMY0 = reg;
+	uint16_t reg = *((uint16_t*)a);
+	
+	if (reg < 10 || reg > 60000)
+		return false;
+	
+	app_regs.REG_IN_MEASURE_WINDOW_MS = reg;
 	return true;
 }
 
 
 /************************************************************************/
-/* REG_EVNT_ENABLE                                                      */
+/* REG_IN0_MEASURE                                                      */
 /************************************************************************/
-void app_read_REG_EVNT_ENABLE(void)
+void app_read_REG_IN0_MEASURE(void) {}
+bool app_write_REG_IN0_MEASURE(void *a)
 {
-	//app_regs.REG_EVNT_ENABLE = 0;
-
+	return false;
 }
 
-bool app_write_REG_EVNT_ENABLE(void *a)
-{
-	uint8_t reg = *((uint8_t*)a);
 
-	app_regs.REG_EVNT_ENABLE = reg;
-	return true;
+/************************************************************************/
+/* REG_IN1_MEASURE                                                      */
+/************************************************************************/
+void app_read_REG_IN1_MEASURE(void) {}
+bool app_write_REG_IN1_MEASURE(void *a)
+{
+	return false;
 }
\ No newline at end of file
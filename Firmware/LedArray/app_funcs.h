@@ -54,6 +54,83 @@ void app_read_REG_AUX_SUPPLY_PWR_CONF(void);
 void app_read_REG_OUT_STATE(void);
 void app_read_REG_DUMMY0(void);
 void app_read_REG_EVNT_ENABLE(void);
+void app_read_REG_LED0_SEGMENTS_INDEX(void);
+void app_read_REG_LED0_SEGMENTS(void);
+void app_read_REG_LED1_SEGMENTS_INDEX(void);
+void app_read_REG_LED1_SEGMENTS(void);
+void app_read_REG_LED0_CHIRP_FREQ_START(void);
+void app_read_REG_LED0_CHIRP_FREQ_END(void);
+void app_read_REG_LED0_CHIRP_PERIODS(void);
+void app_read_REG_LED1_CHIRP_FREQ_START(void);
+void app_read_REG_LED1_CHIRP_FREQ_END(void);
+void app_read_REG_LED1_CHIRP_PERIODS(void);
+void app_read_REG_LED0_INTERVAL_ON_US(void);
+void app_read_REG_LED0_INTERVAL_OFF_US(void);
+void app_read_REG_LED0_INTERVAL_TAIL_US(void);
+void app_read_REG_LED1_INTERVAL_ON_US(void);
+void app_read_REG_LED1_INTERVAL_OFF_US(void);
+void app_read_REG_LED1_INTERVAL_TAIL_US(void);
+void app_read_REG_LED0_START_LATENCY(void);
+void app_read_REG_LED1_START_LATENCY(void);
+void app_read_REG_LED_SYNC_OFFSET(void);
+void app_read_REG_LED_SCHEDULE_SECOND(void);
+void app_read_REG_LED_SCHEDULE_MICRO(void);
+void app_read_REG_LED_SCHEDULE(void);
+void app_read_REG_LED0_ENVELOPE_FREQ(void);
+void app_read_REG_LED0_ENVELOPE_DEPTH(void);
+void app_read_REG_LED0_ENVELOPE_OFFSET(void);
+void app_read_REG_LED0_ENVELOPE_CYCLES(void);
+void app_read_REG_LED1_ENVELOPE_FREQ(void);
+void app_read_REG_LED1_ENVELOPE_DEPTH(void);
+void app_read_REG_LED1_ENVELOPE_OFFSET(void);
+void app_read_REG_LED1_ENVELOPE_CYCLES(void);
+void app_read_REG_LED_ENVELOPE_SHAPE(void);
+void app_read_REG_LED0_PWM_PERIOD(void);
+void app_read_REG_LED0_PWM_ON(void);
+void app_read_REG_LED1_PWM_PERIOD(void);
+void app_read_REG_LED1_PWM_ON(void);
+void app_read_REG_LED0_QUEUE(void);
+void app_read_REG_LED0_QUEUE_COUNT(void);
+void app_read_REG_LED1_QUEUE(void);
+void app_read_REG_LED1_QUEUE_COUNT(void);
+void app_read_REG_LED0_PWM_PULSES_LONG(void);
+void app_read_REG_LED0_INTERVAL_REPS_LONG(void);
+void app_read_REG_LED1_PWM_PULSES_LONG(void);
+void app_read_REG_LED1_INTERVAL_REPS_LONG(void);
+void app_read_REG_LED_JITTER(void);
+void app_read_REG_LED0_JITTER_MIN_US(void);
+void app_read_REG_LED0_JITTER_MAX_US(void);
+void app_read_REG_LED0_JITTER_SEED(void);
+void app_read_REG_LED0_JITTER_OFF_US(void);
+void app_read_REG_LED1_JITTER_MIN_US(void);
+void app_read_REG_LED1_JITTER_MAX_US(void);
+void app_read_REG_LED1_JITTER_SEED(void);
+void app_read_REG_LED1_JITTER_OFF_US(void);
+void app_read_REG_LED0_PROGRAM_INDEX(void);
+void app_read_REG_LED0_PROGRAM(void);
+void app_read_REG_LED0_PROGRAM_EVENT(void);
+void app_read_REG_LED1_PROGRAM_INDEX(void);
+void app_read_REG_LED1_PROGRAM(void);
+void app_read_REG_LED1_PROGRAM_EVENT(void);
+void app_read_REG_LED_DEAD_TIME(void);
+void app_read_REG_LED0_NEST(void);
+void app_read_REG_LED1_NEST(void);
+void app_read_REG_LED0_PROGRESS(void);
+void app_read_REG_LED1_PROGRESS(void);
+void app_read_REG_IN_CAPTURE(void);
+void app_read_REG_IN_CAPTURE_EDGES(void);
+void app_read_REG_IN_CAPTURE_PERIOD(void);
+void app_read_REG_IN_CAPTURE_EVENT(void);
+void app_read_REG_IN_EVENT_CONF(void);
+void app_read_REG_IN_EVENT_NTH(void);
+void app_read_REG_IN_EVENT_PERIOD_US(void);
+void app_read_REG_IN_EDGES(void);
+void app_read_REG_IN_FILTER_SAMPLES(void);
+void app_read_REG_IN_HOLDOFF_MS(void);
+void app_read_REG_IN_MEASURE(void);
+void app_read_REG_IN_MEASURE_WINDOW_MS(void);
+void app_read_REG_IN0_MEASURE(void);
+void app_read_REG_IN1_MEASURE(void);
 
 bool app_write_REG_POWER_EN(void *a);
 bool app_write_REG_LED_BEHAVING(void *a);
@@ -89,6 +166,83 @@ bool app_write_REG_AUX_SUPPLY_PWR_CONF(void *a);
 bool app_write_REG_OUT_STATE(void *a);
 bool app_write_REG_DUMMY0(void *a);
 bool app_write_REG_EVNT_ENABLE(void *a);
+bool app_write_REG_LED0_SEGMENTS_INDEX(void *a);
+bool app_write_REG_LED0_SEGMENTS(void *a);
+bool app_write_REG_LED1_SEGMENTS_INDEX(void *a);
+bool app_write_REG_LED1_SEGMENTS(void *a);
+bool app_write_REG_LED0_CHIRP_FREQ_START(void *a);
+bool app_write_REG_LED0_CHIRP_FREQ_END(void *a);
+bool app_write_REG_LED0_CHIRP_PERIODS(void *a);
+bool app_write_REG_LED1_CHIRP_FREQ_START(void *a);
+bool app_write_REG_LED1_CHIRP_FREQ_END(void *a);
+bool app_write_REG_LED1_CHIRP_PERIODS(void *a);
+bool app_write_REG_LED0_INTERVAL_ON_US(void *a);
+bool app_write_REG_LED0_INTERVAL_OFF_US(void *a);
+bool app_write_REG_LED0_INTERVAL_TAIL_US(void *a);
+bool app_write_REG_LED1_INTERVAL_ON_US(void *a);
+bool app_write_REG_LED1_INTERVAL_OFF_US(void *a);
+bool app_write_REG_LED1_INTERVAL_TAIL_US(void *a);
+bool app_write_REG_LED0_START_LATENCY(void *a);
+bool app_write_REG_LED1_START_LATENCY(void *a);
+bool app_write_REG_LED_SYNC_OFFSET(void *a);
+bool app_write_REG_LED_SCHEDULE_SECOND(void *a);
+bool app_write_REG_LED_SCHEDULE_MICRO(void *a);
+bool app_write_REG_LED_SCHEDULE(void *a);
+bool app_write_REG_LED0_ENVELOPE_FREQ(void *a);
+bool app_write_REG_LED0_ENVELOPE_DEPTH(void *a);
+bool app_write_REG_LED0_ENVELOPE_OFFSET(void *a);
+bool app_write_REG_LED0_ENVELOPE_CYCLES(void *a);
+bool app_write_REG_LED1_ENVELOPE_FREQ(void *a);
+bool app_write_REG_LED1_ENVELOPE_DEPTH(void *a);
+bool app_write_REG_LED1_ENVELOPE_OFFSET(void *a);
+bool app_write_REG_LED1_ENVELOPE_CYCLES(void *a);
+bool app_write_REG_LED_ENVELOPE_SHAPE(void *a);
+bool app_write_REG_LED0_PWM_PERIOD(void *a);
+bool app_write_REG_LED0_PWM_ON(void *a);
+bool app_write_REG_LED1_PWM_PERIOD(void *a);
+bool app_write_REG_LED1_PWM_ON(void *a);
+bool app_write_REG_LED0_QUEUE(void *a);
+bool app_write_REG_LED0_QUEUE_COUNT(void *a);
+bool app_write_REG_LED1_QUEUE(void *a);
+bool app_write_REG_LED1_QUEUE_COUNT(void *a);
+bool app_write_REG_LED0_PWM_PULSES_LONG(void *a);
+bool app_write_REG_LED0_INTERVAL_REPS_LONG(void *a);
+bool app_write_REG_LED1_PWM_PULSES_LONG(void *a);
+bool app_write_REG_LED1_INTERVAL_REPS_LONG(void *a);
+bool app_write_REG_LED_JITTER(void *a);
+bool app_write_REG_LED0_JITTER_MIN_US(void *a);
+bool app_write_REG_LED0_JITTER_MAX_US(void *a);
+bool app_write_REG_LED0_JITTER_SEED(void *a);
+bool app_write_REG_LED0_JITTER_OFF_US(void *a);
+bool app_write_REG_LED1_JITTER_MIN_US(void *a);
+bool app_write_REG_LED1_JITTER_MAX_US(void *a);
+bool app_write_REG_LED1_JITTER_SEED(void *a);
+bool app_write_REG_LED1_JITTER_OFF_US(void *a);
+bool app_write_REG_LED0_PROGRAM_INDEX(void *a);
+bool app_write_REG_LED0_PROGRAM(void *a);
+bool app_write_REG_LED0_PROGRAM_EVENT(void *a);
+bool app_write_REG_LED1_PROGRAM_INDEX(void *a);
+bool app_write_REG_LED1_PROGRAM(void *a);
+bool app_write_REG_LED1_PROGRAM_EVENT(void *a);
+bool app_write_REG_LED_DEAD_TIME(void *a);
+bool app_write_REG_LED0_NEST(void *a);
+bool app_write_REG_LED1_NEST(void *a);
+bool app_write_REG_LED0_PROGRESS(void *a);
+bool app_write_REG_LED1_PROGRESS(void *a);
+bool app_write_REG_IN_CAPTURE(void *a);
+bool app_write_REG_IN_CAPTURE_EDGES(void *a);
+bool app_write_REG_IN_CAPTURE_PERIOD(void *a);
+bool app_write_REG_IN_CAPTURE_EVENT(void *a);
+bool app_write_REG_IN_EVENT_CONF(void *a);
+bool app_write_REG_IN_EVENT_NTH(void *a);
+bool app_write_REG_IN_EVENT_PERIOD_US(void *a);
+bool app_write_REG_IN_EDGES(void *a);
+bool app_write_REG_IN_FILTER_SAMPLES(void *a);
+bool app_write_REG_IN_HOLDOFF_MS(void *a);
+bool app_write_REG_IN_MEASURE(void *a);
+bool app_write_REG_IN_MEASURE_WINDOW_MS(void *a);
+bool app_write_REG_IN0_MEASURE(void *a);
+bool app_write_REG_IN1_MEASURE(void *a);
 
 
 #endif /* _APP_FUNCTIONS_H_ */
\ No newline at end of file
@@ -80,7 +80,84 @@ uint8_t app_regs_type[] = {
 	TYPE_U8,
 	TYPE_U8,
 	TYPE_U8,
-	TYPE_U8
+	TYPE_U8,
+	TYPE_U8,
+	TYPE_U32,
+	TYPE_U8,
+	TYPE_U32,
+	TYPE_FLOAT,
+	TYPE_FLOAT,
+	TYPE_U8,
+	TYPE_FLOAT,
+	TYPE_FLOAT,
+	TYPE_U8,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U16,
+	TYPE_U16,
+	TYPE_U16,
+	TYPE_U32,
+	TYPE_U16,
+	TYPE_U8,
+	TYPE_FLOAT,
+	TYPE_FLOAT,
+	TYPE_FLOAT,
+	TYPE_U16,
+	TYPE_FLOAT,
+	TYPE_FLOAT,
+	TYPE_FLOAT,
+	TYPE_U16,
+	TYPE_U8,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U8,
+	TYPE_U32,
+	TYPE_U8,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U8,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U8,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U8,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U16,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U32,
+	TYPE_U8,
+	TYPE_U8,
+	TYPE_U16,
+	TYPE_U16,
+	TYPE_U8,
+	TYPE_U16,
+	TYPE_U32,
+	TYPE_U16,
+	TYPE_U8,
+	TYPE_U8,
+	TYPE_U8,
+	TYPE_U16,
+	TYPE_FLOAT,
+	TYPE_FLOAT
 };
 
 uint16_t app_regs_n_elements[] = {
@@ -117,7 +194,84 @@ uint16_t app_regs_n_elements[] = {
 	1,
 	1,
 	1,
-	1
+	1,
+	1,
+	8,
+	1,
+	8,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	5,
+	1,
+	5,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	8,
+	1,
+	1,
+	8,
+	1,
+	1,
+	10,
+	10,
+	4,
+	4,
+	1,
+	1,
+	1,
+	16,
+	1,
+	2,
+	2,
+	2,
+	2,
+	2,
+	1,
+	1,
+	4,
+	4
 };
 
 uint8_t *app_regs_pointer[] = {
@@ -154,5 +308,82 @@ uint8_t *app_regs_pointer[] = {
 	(uint8_t*)(&app_regs.REG_AUX_SUPPLY_PWR_CONF),
 	(uint8_t*)(&app_regs.REG_OUT_STATE),
 	(uint8_t*)(&app_regs.REG_DUMMY0),
-	(uint8_t*)(&app_regs.REG_EVNT_ENABLE)
+	(uint8_t*)(&app_regs.REG_EVNT_ENABLE),
+	(uint8_t*)(&app_regs.REG_LED0_SEGMENTS_INDEX),
+	(uint8_t*)(app_regs.REG_LED0_SEGMENTS),
+	(uint8_t*)(&app_regs.REG_LED1_SEGMENTS_INDEX),
+	(uint8_t*)(app_regs.REG_LED1_SEGMENTS),
+	(uint8_t*)(&app_regs.REG_LED0_CHIRP_FREQ_START),
+	(uint8_t*)(&app_regs.REG_LED0_CHIRP_FREQ_END),
+	(uint8_t*)(&app_regs.REG_LED0_CHIRP_PERIODS),
+	(uint8_t*)(&app_regs.REG_LED1_CHIRP_FREQ_START),
+	(uint8_t*)(&app_regs.REG_LED1_CHIRP_FREQ_END),
+	(uint8_t*)(&app_regs.REG_LED1_CHIRP_PERIODS),
+	(uint8_t*)(&app_regs.REG_LED0_INTERVAL_ON_US),
+	(uint8_t*)(&app_regs.REG_LED0_INTERVAL_OFF_US),
+	(uint8_t*)(&app_regs.REG_LED0_INTERVAL_TAIL_US),
+	(uint8_t*)(&app_regs.REG_LED1_INTERVAL_ON_US),
+	(uint8_t*)(&app_regs.REG_LED1_INTERVAL_OFF_US),
+	(uint8_t*)(&app_regs.REG_LED1_INTERVAL_TAIL_US),
+	(uint8_t*)(&app_regs.REG_LED0_START_LATENCY),
+	(uint8_t*)(&app_regs.REG_LED1_START_LATENCY),
+	(uint8_t*)(&app_regs.REG_LED_SYNC_OFFSET),
+	(uint8_t*)(&app_regs.REG_LED_SCHEDULE_SECOND),
+	(uint8_t*)(&app_regs.REG_LED_SCHEDULE_MICRO),
+	(uint8_t*)(&app_regs.REG_LED_SCHEDULE),
+	(uint8_t*)(&app_regs.REG_LED0_ENVELOPE_FREQ),
+	(uint8_t*)(&app_regs.REG_LED0_ENVELOPE_DEPTH),
+	(uint8_t*)(&app_regs.REG_LED0_ENVELOPE_OFFSET),
+	(uint8_t*)(&app_regs.REG_LED0_ENVELOPE_CYCLES),
+	(uint8_t*)(&app_regs.REG_LED1_ENVELOPE_FREQ),
+	(uint8_t*)(&app_regs.REG_LED1_ENVELOPE_DEPTH),
+	(uint8_t*)(&app_regs.REG_LED1_ENVELOPE_OFFSET),
+	(uint8_t*)(&app_regs.REG_LED1_ENVELOPE_CYCLES),
+	(uint8_t*)(&app_regs.REG_LED_ENVELOPE_SHAPE),
+	(uint8_t*)(&app_regs.REG_LED0_PWM_PERIOD),
+	(uint8_t*)(&app_regs.REG_LED0_PWM_ON),
+	(uint8_t*)(&app_regs.REG_LED1_PWM_PERIOD),
+	(uint8_t*)(&app_regs.REG_LED1_PWM_ON),
+	(uint8_t*)(app_regs.REG_LED0_QUEUE),
+	(uint8_t*)(&app_regs.REG_LED0_QUEUE_COUNT),
+	(uint8_t*)(app_regs.REG_LED1_QUEUE),
+	(uint8_t*)(&app_regs.REG_LED1_QUEUE_COUNT),
+	(uint8_t*)(&app_regs.REG_LED0_PWM_PULSES_LONG),
+	(uint8_t*)(&app_regs.REG_LED0_INTERVAL_REPS_LONG),
+	(uint8_t*)(&app_regs.REG_LED1_PWM_PULSES_LONG),
+	(uint8_t*)(&app_regs.REG_LED1_INTERVAL_REPS_LONG),
+	(uint8_t*)(&app_regs.REG_LED_JITTER),
+	(uint8_t*)(&app_regs.REG_LED0_JITTER_MIN_US),
+	(uint8_t*)(&app_regs.REG_LED0_JITTER_MAX_US),
+	(uint8_t*)(&app_regs.REG_LED0_JITTER_SEED),
+	(uint8_t*)(&app_regs.REG_LED0_JITTER_OFF_US),
+	(uint8_t*)(&app_regs.REG_LED1_JITTER_MIN_US),
+	(uint8_t*)(&app_regs.REG_LED1_JITTER_MAX_US),
+	(uint8_t*)(&app_regs.REG_LED1_JITTER_SEED),
+	(uint8_t*)(&app_regs.REG_LED1_JITTER_OFF_US),
+	(uint8_t*)(&app_regs.REG_LED0_PROGRAM_INDEX),
+	(uint8_t*)(app_regs.REG_LED0_PROGRAM),
+	(uint8_t*)(&app_regs.REG_LED0_PROGRAM_EVENT),
+	(uint8_t*)(&app_regs.REG_LED1_PROGRAM_INDEX),
+	(uint8_t*)(app_regs.REG_LED1_PROGRAM),
+	(uint8_t*)(&app_regs.REG_LED1_PROGRAM_EVENT),
+	(uint8_t*)(&app_regs.REG_LED_DEAD_TIME),
+	(uint8_t*)(app_regs.REG_LED0_NEST),
+	(uint8_t*)(app_regs.REG_LED1_NEST),
+	(uint8_t*)(app_regs.REG_LED0_PROGRESS),
+	(uint8_t*)(app_regs.REG_LED1_PROGRESS),
+	(uint8_t*)(&app_regs.REG_IN_CAPTURE),
+	(uint8_t*)(&app_regs.REG_IN_CAPTURE_EDGES),
+	(uint8_t*)(&app_regs.REG_IN_CAPTURE_PERIOD),
+	(uint8_t*)(app_regs.REG_IN_CAPTURE_EVENT),
+	(uint8_t*)(&app_regs.REG_IN_EVENT_CONF),
+	(uint8_t*)(app_regs.REG_IN_EVENT_NTH),
+	(uint8_t*)(app_regs.REG_IN_EVENT_PERIOD_US),
+	(uint8_t*)(app_regs.REG_IN_EDGES),
+	(uint8_t*)(app_regs.REG_IN_FILTER_SAMPLES),
+	(uint8_t*)(app_regs.REG_IN_HOLDOFF_MS),
+	(uint8_t*)(&app_regs.REG_IN_MEASURE),
+	(uint8_t*)(&app_regs.REG_IN_MEASURE_WINDOW_MS),
+	(uint8_t*)(app_regs.REG_IN0_MEASURE),
+	(uint8_t*)(app_regs.REG_IN1_MEASURE)
 };
\ No newline at end of file
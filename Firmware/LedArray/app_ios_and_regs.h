@@ -130,6 +130,83 @@ typedef struct
 	uint8_t REG_OUT_STATE;
 	uint8_t REG_DUMMY0;
 	uint8_t REG_EVNT_ENABLE;
+	uint8_t REG_LED0_SEGMENTS_INDEX;
+	uint32_t REG_LED0_SEGMENTS[8];
+	uint8_t REG_LED1_SEGMENTS_INDEX;
+	uint32_t REG_LED1_SEGMENTS[8];
+	float REG_LED0_CHIRP_FREQ_START;
+	float REG_LED0_CHIRP_FREQ_END;
+	uint8_t REG_LED0_CHIRP_PERIODS;
+	float REG_LED1_CHIRP_FREQ_START;
+	float REG_LED1_CHIRP_FREQ_END;
+	uint8_t REG_LED1_CHIRP_PERIODS;
+	uint32_t REG_LED0_INTERVAL_ON_US;
+	uint32_t REG_LED0_INTERVAL_OFF_US;
+	uint32_t REG_LED0_INTERVAL_TAIL_US;
+	uint32_t REG_LED1_INTERVAL_ON_US;
+	uint32_t REG_LED1_INTERVAL_OFF_US;
+	uint32_t REG_LED1_INTERVAL_TAIL_US;
+	uint16_t REG_LED0_START_LATENCY;
+	uint16_t REG_LED1_START_LATENCY;
+	uint16_t REG_LED_SYNC_OFFSET;
+	uint32_t REG_LED_SCHEDULE_SECOND;
+	uint16_t REG_LED_SCHEDULE_MICRO;
+	uint8_t REG_LED_SCHEDULE;
+	float REG_LED0_ENVELOPE_FREQ;
+	float REG_LED0_ENVELOPE_DEPTH;
+	float REG_LED0_ENVELOPE_OFFSET;
+	uint16_t REG_LED0_ENVELOPE_CYCLES;
+	float REG_LED1_ENVELOPE_FREQ;
+	float REG_LED1_ENVELOPE_DEPTH;
+	float REG_LED1_ENVELOPE_OFFSET;
+	uint16_t REG_LED1_ENVELOPE_CYCLES;
+	uint8_t REG_LED_ENVELOPE_SHAPE;
+	uint32_t REG_LED0_PWM_PERIOD;
+	uint32_t REG_LED0_PWM_ON;
+	uint32_t REG_LED1_PWM_PERIOD;
+	uint32_t REG_LED1_PWM_ON;
+	uint32_t REG_LED0_QUEUE[5];
+	uint8_t REG_LED0_QUEUE_COUNT;
+	uint32_t REG_LED1_QUEUE[5];
+	uint8_t REG_LED1_QUEUE_COUNT;
+	uint32_t REG_LED0_PWM_PULSES_LONG;
+	uint32_t REG_LED0_INTERVAL_REPS_LONG;
+	uint32_t REG_LED1_PWM_PULSES_LONG;
+	uint32_t REG_LED1_INTERVAL_REPS_LONG;
+	uint8_t REG_LED_JITTER;
+	uint32_t REG_LED0_JITTER_MIN_US;
+	uint32_t REG_LED0_JITTER_MAX_US;
+	uint32_t REG_LED0_JITTER_SEED;
+	uint32_t REG_LED0_JITTER_OFF_US;
+	uint32_t REG_LED1_JITTER_MIN_US;
+	uint32_t REG_LED1_JITTER_MAX_US;
+	uint32_t REG_LED1_JITTER_SEED;
+	uint32_t REG_LED1_JITTER_OFF_US;
+	uint8_t REG_LED0_PROGRAM_INDEX;
+	uint32_t REG_LED0_PROGRAM[8];
+	uint32_t REG_LED0_PROGRAM_EVENT;
+	uint8_t REG_LED1_PROGRAM_INDEX;
+	uint32_t REG_LED1_PROGRAM[8];
+	uint32_t REG_LED1_PROGRAM_EVENT;
+	uint16_t REG_LED_DEAD_TIME;
+	uint32_t REG_LED0_NEST[10];
+	uint32_t REG_LED1_NEST[10];
+	uint32_t REG_LED0_PROGRESS[4];
+	uint32_t REG_LED1_PROGRESS[4];
+	uint8_t REG_IN_CAPTURE;
+	uint8_t REG_IN_CAPTURE_EDGES;
+	uint16_t REG_IN_CAPTURE_PERIOD;
+	uint16_t REG_IN_CAPTURE_EVENT[16];
+	uint8_t REG_IN_EVENT_CONF;
+	uint16_t REG_IN_EVENT_NTH[2];
+	uint32_t REG_IN_EVENT_PERIOD_US[2];
+	uint16_t REG_IN_EDGES[2];
+	uint8_t REG_IN_FILTER_SAMPLES[2];
+	uint8_t REG_IN_HOLDOFF_MS[2];
+	uint8_t REG_IN_MEASURE;
+	uint16_t REG_IN_MEASURE_WINDOW_MS;
+	float REG_IN0_MEASURE[4];
+	float REG_IN1_MEASURE[4];
 } AppRegs;
 
 /************************************************************************/
@@ -145,7 +222,7 @@ typedef struct
 #define ADD_REG_LED_CONFIGURATION           38 // U8     Configures how LEDs will behave
 #define ADD_REG_LED0_SUPPLY_PWR_CONF        39 // U8     Configuration of power to be aplied to LED0 [1;120]
 #define ADD_REG_LED1_SUPPLY_PWR_CONF        40 // U8     Configuration of power to be aplied to LED1 [1;120]
-#define ADD_REG_LED0_PWM_FREQ               41 // FLOAT  PWM frequency of LED0's power transistor [0.5;2000.0]
+#define ADD_REG_LED0_PWM_FREQ               41 // FLOAT  PWM frequency of LED0's power transistor [0.01;50000.0]
 #define ADD_REG_LED0_PWM_DCYCLE             42 // FLOAT  PWM duty cycle of LED0's power transistor [0.1;99.9]
 #define ADD_REG_LED0_PWM_PULSES             43 // U16    Number of PWM pulses (LED0) [1;65535]
 #define ADD_REG_LED0_INTERVAL_ON            44 // U16    Time ON of LED0 (milliseconds) [1;65535]
@@ -153,7 +230,7 @@ typedef struct
 #define ADD_REG_LED0_INTERVAL_PULSES        46 // U16    Number of pulses (LED0) [1;65535]
 #define ADD_REG_LED0_INTERVAL_TAIL          47 // U16    Wait time between pulses (milliseconds) (LED0) [1;65535]
 #define ADD_REG_LED0_INTERVAL_REPS          48 // U16    Number of repetitions of the entire scheme (LED0) [1;65535]
-#define ADD_REG_LED1_PWM_FREQ               49 // FLOAT  PWM frequency of LED1's power transistor [0.5;2000.0]
+#define ADD_REG_LED1_PWM_FREQ               49 // FLOAT  PWM frequency of LED1's power transistor [0.01;50000.0]
 #define ADD_REG_LED1_PWM_DCYCLE             50 // FLOAT  PWM duty cycle of LED1's power transistor [0.1;99.9]
 #define ADD_REG_LED1_PWM_PULSES             51 // U16    Number of PWM pulses (LED1) [1;65535]
 #define ADD_REG_LED1_INTERVAL_ON            52 // U16    Time ON of LED1 (milliseconds) [1;65535]
@@ -170,6 +247,83 @@ typedef struct
 #define ADD_REG_OUT_STATE                   63 // U8     Digital output control
 #define ADD_REG_DUMMY0                      64 // U8     Not used
 #define ADD_REG_EVNT_ENABLE                 65 // U8     Enable the Events
+#define ADD_REG_LED0_SEGMENTS_INDEX         66 // U8     Index of the next segment written to LED0's table [0;24]
+#define ADD_REG_LED0_SEGMENTS               67 // U32    Chunk of segments written to LED0's table
+#define ADD_REG_LED1_SEGMENTS_INDEX         68 // U8     Index of the next segment written to LED1's table [0;24]
+#define ADD_REG_LED1_SEGMENTS               69 // U32    Chunk of segments written to LED1's table
+#define ADD_REG_LED0_CHIRP_FREQ_START       70 // FLOAT  Chirp's first frequency of LED0 [0.5;2000.0]
+#define ADD_REG_LED0_CHIRP_FREQ_END         71 // FLOAT  Chirp's last frequency of LED0 [0.5;2000.0]
+#define ADD_REG_LED0_CHIRP_PERIODS          72 // U8     Number of periods of LED0's chirp [2;32]
+#define ADD_REG_LED1_CHIRP_FREQ_START       73 // FLOAT  Chirp's first frequency of LED1 [0.5;2000.0]
+#define ADD_REG_LED1_CHIRP_FREQ_END         74 // FLOAT  Chirp's last frequency of LED1 [0.5;2000.0]
+#define ADD_REG_LED1_CHIRP_PERIODS          75 // U8     Number of periods of LED1's chirp [2;32]
+#define ADD_REG_LED0_INTERVAL_ON_US         76 // U32    Time ON of LED0 (microseconds) [20;100000000]
+#define ADD_REG_LED0_INTERVAL_OFF_US        77 // U32    Time OFF of LED0 (microseconds) [20;100000000]
+#define ADD_REG_LED0_INTERVAL_TAIL_US       78 // U32    Wait time between pulses (microseconds) (LED0) [0;100000000]
+#define ADD_REG_LED1_INTERVAL_ON_US         79 // U32    Time ON of LED1 (microseconds) [20;100000000]
+#define ADD_REG_LED1_INTERVAL_OFF_US        80 // U32    Time OFF of LED1 (microseconds) [20;100000000]
+#define ADD_REG_LED1_INTERVAL_TAIL_US       81 // U32    Wait time between pulses (microseconds) (LED1) [0;100000000]
+#define ADD_REG_LED0_START_LATENCY          82 // U16    Cycles from LED0's start command to its first edge (32 MHz)
+#define ADD_REG_LED1_START_LATENCY          83 // U16    Cycles from LED1's start command to its first edge (32 MHz)
+#define ADD_REG_LED_SYNC_OFFSET             84 // U16    Ticks LED1 lags LED0 when both start together
+#define ADD_REG_LED_SCHEDULE_SECOND         85 // U32    Harp second of the scheduled start
+#define ADD_REG_LED_SCHEDULE_MICRO          86 // U16    Harp microseconds (32 us units) of the scheduled start [0;31249]
+#define ADD_REG_LED_SCHEDULE                87 // U8     LEDs started at the scheduled time
+#define ADD_REG_LED0_ENVELOPE_FREQ          88 // FLOAT  Envelope frequency of LED0 [0.1;200.0]
+#define ADD_REG_LED0_ENVELOPE_DEPTH         89 // FLOAT  Envelope depth of LED0 (% of the carrier period) [0.0;100.0]
+#define ADD_REG_LED0_ENVELOPE_OFFSET        90 // FLOAT  Envelope offset of LED0 (% of the carrier period) [0.0;100.0]
+#define ADD_REG_LED0_ENVELOPE_CYCLES        91 // U16    Number of envelope cycles (LED0) [1;65535]
+#define ADD_REG_LED1_ENVELOPE_FREQ          92 // FLOAT  Envelope frequency of LED1 [0.1;200.0]
+#define ADD_REG_LED1_ENVELOPE_DEPTH         93 // FLOAT  Envelope depth of LED1 (% of the carrier period) [0.0;100.0]
+#define ADD_REG_LED1_ENVELOPE_OFFSET        94 // FLOAT  Envelope offset of LED1 (% of the carrier period) [0.0;100.0]
+#define ADD_REG_LED1_ENVELOPE_CYCLES        95 // U16    Number of envelope cycles (LED1) [1;65535]
+#define ADD_REG_LED_ENVELOPE_SHAPE          96 // U8     Waveform of the LEDs' envelopes
+#define ADD_REG_LED0_PWM_PERIOD             97 // U32    PWM period of LED0 (32 MHz ticks) [640;3200000000]
+#define ADD_REG_LED0_PWM_ON                 98 // U32    PWM ON time of LED0 (32 MHz ticks) [1;PERIOD-1]
+#define ADD_REG_LED1_PWM_PERIOD             99 // U32    PWM period of LED1 (32 MHz ticks) [640;3200000000]
+#define ADD_REG_LED1_PWM_ON                 100 // U32    PWM ON time of LED1 (32 MHz ticks) [1;PERIOD-1]
+#define ADD_REG_LED0_QUEUE                  101 // U32    Protocol appended to LED0's queue
+#define ADD_REG_LED0_QUEUE_COUNT            102 // U8     Protocols waiting on LED0's queue [0;4]
+#define ADD_REG_LED1_QUEUE                  103 // U32    Protocol appended to LED1's queue
+#define ADD_REG_LED1_QUEUE_COUNT            104 // U8     Protocols waiting on LED1's queue [0;4]
+#define ADD_REG_LED0_PWM_PULSES_LONG        105 // U32    Number of PWM pulses, 0 runs until stopped (LED0)
+#define ADD_REG_LED0_INTERVAL_REPS_LONG     106 // U32    Number of repetitions, 0 runs until stopped (LED0)
+#define ADD_REG_LED1_PWM_PULSES_LONG        107 // U32    Number of PWM pulses, 0 runs until stopped (LED1)
+#define ADD_REG_LED1_INTERVAL_REPS_LONG     108 // U32    Number of repetitions, 0 runs until stopped (LED1)
+#define ADD_REG_LED_JITTER                  109 // U8     Distribution of the LEDs' OFF times
+#define ADD_REG_LED0_JITTER_MIN_US          110 // U32    Shortest OFF time (LED0)
+#define ADD_REG_LED0_JITTER_MAX_US          111 // U32    Longest OFF time (LED0)
+#define ADD_REG_LED0_JITTER_SEED            112 // U32    Seed of the OFF times (LED0)
+#define ADD_REG_LED0_JITTER_OFF_US          113 // U32    OFF time drawn (LED0)
+#define ADD_REG_LED1_JITTER_MIN_US          114 // U32    Shortest OFF time (LED1)
+#define ADD_REG_LED1_JITTER_MAX_US          115 // U32    Longest OFF time (LED1)
+#define ADD_REG_LED1_JITTER_SEED            116 // U32    Seed of the OFF times (LED1)
+#define ADD_REG_LED1_JITTER_OFF_US          117 // U32    OFF time drawn (LED1)
+#define ADD_REG_LED0_PROGRAM_INDEX          118 // U8     Index of the next instruction written to LED0's program [0;24]
+#define ADD_REG_LED0_PROGRAM                119 // U32    Chunk of instructions written to LED0's program
+#define ADD_REG_LED0_PROGRAM_EVENT          120 // U32    Argument of the last EVENT instruction (LED0)
+#define ADD_REG_LED1_PROGRAM_INDEX          121 // U8     Index of the next instruction written to LED1's program [0;24]
+#define ADD_REG_LED1_PROGRAM                122 // U32    Chunk of instructions written to LED1's program
+#define ADD_REG_LED1_PROGRAM_EVENT          123 // U32    Argument of the last EVENT instruction (LED1)
+#define ADD_REG_LED_DEAD_TIME               124 // U16    32 MHz cycles both LEDs are off between the complementary phases
+#define ADD_REG_LED0_NEST                   125 // U32    ON and OFF microseconds, then count and gap microseconds of each level
+#define ADD_REG_LED1_NEST                   126 // U32    ON and OFF microseconds, then count and gap microseconds of each level
+#define ADD_REG_LED0_PROGRESS               127 // U32    Pulses started, repetition, elapsed and remaining microseconds
+#define ADD_REG_LED1_PROGRESS               128 // U32    Pulses started, repetition, elapsed and remaining microseconds
+#define ADD_REG_IN_CAPTURE                  129 // U8     Inputs whose edges are captured into IN_CAPTURE_EVENT
+#define ADD_REG_IN_CAPTURE_EDGES            130 // U8     Edges of a capture event [1;16]
+#define ADD_REG_IN_CAPTURE_PERIOD           131 // U16    Milliseconds after which an incomplete capture event is sent, 0 waits for the edges
+#define ADD_REG_IN_CAPTURE_EVENT            132 // U16    Ticks of 32 us between captured edges, with the input and its level
+#define ADD_REG_IN_EVENT_CONF               133 // U8     Configures which edges of the inputs send events
+#define ADD_REG_IN_EVENT_NTH                134 // U16    Edges of IN0 and IN1 per event when sending every Nth edge [1;65535]
+#define ADD_REG_IN_EVENT_PERIOD_US          135 // U32    Shortest time between rate limited events of IN0 and IN1 [32;100000000]
+#define ADD_REG_IN_EDGES                    136 // U16    Edges counted on IN0 and IN1
+#define ADD_REG_IN_FILTER_SAMPLES           137 // U8     Samples of 31.25 ns an edge of IN0 and IN1 must hold to reach the actions [1;8]
+#define ADD_REG_IN_HOLDOFF_MS               138 // U8     Milliseconds the interrupts of IN0 and IN1 ignore the edges after one, 0 disables [0;255]
+#define ADD_REG_IN_MEASURE                  139 // U8     Inputs whose period, frequency and duty cycle are measured
+#define ADD_REG_IN_MEASURE_WINDOW_MS        140 // U16    Gate window of the input measurements [10;60000]
+#define ADD_REG_IN0_MEASURE                 141 // FLOAT  IN0's period (us), frequency (Hz), duty cycle (%) and edges over the last window
+#define ADD_REG_IN1_MEASURE                 142 // FLOAT  IN1's period (us), frequency (Hz), duty cycle (%) and edges over the last window
 
 /************************************************************************/
 /* PWM Generator registers' memory limits                               */
@@ -179,8 +333,8 @@ typedef struct
 /************************************************************************/
 /* Memory limits */
 #define APP_REGS_ADD_MIN                    0x20
-#define APP_REGS_ADD_MAX                    0x41
-#define APP_NBYTES_OF_REG_BANK              70
+#define APP_REGS_ADD_MAX                    0x8E
+#define APP_NBYTES_OF_REG_BANK              607
 
 /************************************************************************/
 /* Registers' bits                                                      */
@@ -225,12 +379,61 @@ typedef struct
 #define GM_IN1_CONF_LED1_START             (4<<4)       // IN1 controls bit LED1_START
 #define GM_IN1_CONF_LED1_ON                (5<<4)       // IN1 controls bit LED1_ON
 #define GM_IN1_CONF_NOT                    (6<<4)       // IN1 Controls nothing
-#define MSK_LED0_CONF                      (3<<0)       // Configure LED0
-#define MSK_LED1_CONF                      (3<<4)       // Configure LED1
+#define MSK_LED0_CONF                      (15<<0)      // Configure LED0
+#define MSK_LED1_CONF                      (15<<4)      // Configure LED1
 #define GM_LED0_PWM                        (0<<0)       // LED0 uses configured PWM
 #define GM_LED0_INTERVAL                   (1<<0)       // LED0 uses configured intervals
+#define GM_LED0_PWM_HW                     (2<<0)       // LED0 uses configured PWM with pulses counted by hardware
+#define GM_LED0_SEGMENTS                   (3<<0)       // LED0 plays its segments' table
+#define GM_LED0_CHIRP                      (4<<0)       // LED0 sweeps its PWM frequency
+#define GM_LED0_INTERVAL_US                (5<<0)       // LED0 uses configured intervals in microseconds
+#define GM_LED0_ENVELOPE                   (6<<0)       // LED0 modulates a carrier with its envelope
+#define GM_LED0_BURST                      (7<<0)       // LED0 generates PWM bursts on the intervals' ON time
+#define GM_LED0_PROGRAM                    (8<<0)       // LED0 runs its program
+#define GM_LED0_COMPLEMENTARY              (9<<0)       // LED0 and LED1 alternate with a dead time between them
+#define GM_LED0_NESTED                     (10<<0)      // LED0 runs its nested pulse trains
 #define GM_LED1_PWM                        (0<<4)       // LED1 uses configured PWM
 #define GM_LED1_INTERVAL                   (1<<4)       // LED1 uses configured intervals
+#define GM_LED1_PWM_HW                     (2<<4)       // LED1 uses configured PWM with pulses counted by hardware
+#define GM_LED1_SEGMENTS                   (3<<4)       // LED1 plays its segments' table
+#define GM_LED1_CHIRP                      (4<<4)       // LED1 sweeps its PWM frequency
+#define GM_LED1_INTERVAL_US                (5<<4)       // LED1 uses configured intervals in microseconds
+#define GM_LED1_ENVELOPE                   (6<<4)       // LED1 modulates a carrier with its envelope
+#define GM_LED1_BURST                      (7<<4)       // LED1 generates PWM bursts on the intervals' ON time
+#define GM_LED1_PROGRAM                    (8<<4)       // LED1 runs its program
+#define GM_LED1_NESTED                     (10<<4)      // LED1 runs its nested pulse trains
+#define MSK_LED0_SHAPE                     (3<<0)       // Select LED0's envelope
+#define GM_LED0_SHAPE_SINE                 (0<<0)       // Raised cosine, starting on the offset
+#define GM_LED0_SHAPE_RAMP                 (1<<0)       // Linear ramp from the offset to offset + depth
+#define MSK_LED1_SHAPE                     (3<<4)       // Select LED1's envelope
+#define GM_LED1_SHAPE_SINE                 (0<<4)       // Raised cosine, starting on the offset
+#define GM_LED1_SHAPE_RAMP                 (1<<4)       // Linear ramp from the offset to offset + depth
+#define MSK_LED0_JITTER                    (3<<0)       // Select the distribution of LED0's OFF times
+#define GM_LED0_JITTER_NONE                (0<<0)       // OFF times are the configured ones
+#define GM_LED0_JITTER_UNIFORM             (1<<0)       // OFF times drawn uniformly between the minimum and the maximum
+#define GM_LED0_JITTER_EXPONENTIAL         (2<<0)       // OFF times drawn from the minimum plus an exponential, with the configured OFF time as mean
+#define MSK_LED1_JITTER                    (3<<4)       // Select the distribution of LED1's OFF times
+#define GM_LED1_JITTER_NONE                (0<<4)       // OFF times are the configured ones
+#define GM_LED1_JITTER_UNIFORM             (1<<4)       // OFF times drawn uniformly between the minimum and the maximum
+#define GM_LED1_JITTER_EXPONENTIAL         (2<<4)       // OFF times drawn from the minimum plus an exponential, with the configured OFF time as mean
+#define MSK_SEGMENT_DURATION               (0x3FFFFFFF) // Duration of the segment in microseconds (0 ends the table)
+#define B_SEGMENT_OUT                      (1UL<<30)    // OUTx mirrors the LED during the segment if configured as LEDx_ON
+#define B_SEGMENT_LED_ON                   (1UL<<31)    // LED is on during the segment
+#define MSK_PROGRAM_OP                     (15UL<<28)   // Instruction of the program's word
+#define GM_PROGRAM_END                     (0UL<<28)    // Ends the program, a zero word ends the table
+#define GM_PROGRAM_LED                     (1UL<<28)    // Argument 1 turns the LED on and 0 turns it off
+#define GM_PROGRAM_WAIT                    (2UL<<28)    // Holds the outputs during the argument in microseconds [20;268435455]
+#define GM_PROGRAM_POWER                   (3UL<<28)    // Argument 1 enables the LED supply and 0 disables it
+#define GM_PROGRAM_OUT                     (4UL<<28)    // Argument 1 sets OUTx and 0 clears it, if OUTx is a software output
+#define GM_PROGRAM_LOOP                    (5UL<<28)    // Runs the argument times up to the matching NEXT, 4 levels deep
+#define GM_PROGRAM_NEXT                    (6UL<<28)    // Closes the innermost LOOP
+#define GM_PROGRAM_JUMP                    (7UL<<28)    // Jumps to the instruction on the target
+#define GM_PROGRAM_IF_IN                   (8UL<<28)    // Jumps to the instruction on the target if the input has the level
+#define GM_PROGRAM_EVENT                   (9UL<<28)    // Writes the argument to LEDx_PROGRAM_EVENT when the next period starts
+#define MSK_PROGRAM_ARG                    (0x0FFFFFFF) // Argument of the instruction
+#define MSK_PROGRAM_TARGET                 (0xFF)       // Instruction jumped to [0;31]
+#define B_PROGRAM_IN1                      (1UL<<8)     // IF_IN tests IN1 instead of IN0
+#define B_PROGRAM_IN_HIGH                  (1UL<<9)     // IF_IN jumps if the input is high instead of low
 #define B_AUX0_TO_HIGH                     (1<<0)       // Turn AUX0 to high level if equal to 1
 #define B_AUX1_TO_HIGH                     (1<<1)       // Turn AUX1 to high level if equal to 1
 #define B_AUX0_TO_LOW                      (1<<2)       // Turn AUX0 to low level if equal to 1
@@ -241,5 +444,29 @@ typedef struct
 #define B_OUT1_TO_LOW                      (1<<3)       // Turn OUT1 to low level if equal to 1
 #define B_EVT_LED_ON                       (1<<0)       // Event of register LED_ON
 #define B_EVT_IN_STATE                     (1<<1)       // Event of register IN_STATE
+#define B_EVT_JITTER                       (1<<2)       // Event of registers LEDx_JITTER_OFF_US
+#define B_EVT_PROGRAM                      (1<<3)       // Event of registers LEDx_PROGRAM_EVENT
+#define B_EVT_IN_CAPTURE                   (1<<4)       // Event of register IN_CAPTURE_EVENT
+#define B_EVT_IN_MEASURE                   (1<<5)       // Event of registers INx_MEASURE
+#define B_IN0_CAPTURE                      (1<<0)       // Edges of IN0 are captured instead of sending IN_STATE
+#define B_IN1_CAPTURE                      (1<<1)       // Edges of IN1 are captured instead of sending IN_STATE
+#define MSK_CAPTURE_DELTA                  (0x3FFF)     // Ticks of 32 us since the previous edge, 0 on the first [0;16382]
+#define B_CAPTURE_HIGH                     (1<<14)      // The input is high after the edge
+#define B_CAPTURE_IN1                      (1U<<15)     // The edge is from IN1 instead of IN0
+#define CAPTURE_UNUSED                     (0xFFFF)     // Entries after the last edge of the event
+#define MSK_IN0_EVENT                      (7<<0)       // Configure IN0's events
+#define MSK_IN1_EVENT                      (7<<4)       // Configure IN1's events
+#define GM_IN0_EVENT_EDGES                 (0<<0)       // Every edge of IN0 sends IN_STATE
+#define GM_IN0_EVENT_RISING                (1<<0)       // Rising edges of IN0 send IN_STATE
+#define GM_IN0_EVENT_FALLING               (2<<0)       // Falling edges of IN0 send IN_STATE
+#define GM_IN0_EVENT_NTH                   (3<<0)       // Every IN_EVENT_NTH edges of IN0 send IN_STATE
+#define GM_IN0_EVENT_RATE                  (4<<0)       // IN0 sends IN_EDGES at most once per IN_EVENT_PERIOD_US
+#define GM_IN1_EVENT_EDGES                 (0<<4)       // Every edge of IN1 sends IN_STATE
+#define GM_IN1_EVENT_RISING                (1<<4)       // Rising edges of IN1 send IN_STATE
+#define GM_IN1_EVENT_FALLING               (2<<4)       // Falling edges of IN1 send IN_STATE
+#define GM_IN1_EVENT_NTH                   (3<<4)       // Every IN_EVENT_NTH edges of IN1 send IN_STATE
+#define GM_IN1_EVENT_RATE                  (4<<4)       // IN1 sends IN_EDGES at most once per IN_EVENT_PERIOD_US
+#define B_IN0_MEASURE                      (1<<0)       // IN0 is measured
+#define B_IN1_MEASURE                      (1<<1)       // IN1 is measured
 
 #endif /* _APP_REGS_H_ */
\ No newline at end of file
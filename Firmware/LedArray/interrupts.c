@@ -9,6 +9,12 @@
 /************************************************************************/
 extern AppRegs app_regs;
 
+void capture_edge(uint8_t input);
+void measure_edge(uint8_t input);
+void input_edge(uint8_t input);
+void input_event(uint8_t input);
+void input_holdoff(uint8_t input);
+
 /************************************************************************/
 /* Interrupts from Timers                                               */
 /************************************************************************/
@@ -27,16 +33,31 @@ extern AppRegs app_regs;
 // ISR(TCD1_CCA_vect, ISR_NAKED)
 
 /************************************************************************/ 
-/* IN0                                                                  */
+/* IN0 and IN1                                                          */
 /************************************************************************/
-ISR(PORTD_INT0_vect, ISR_NAKED)
+/* Also taken for an edge left by the input's hold-off */
+void input_interrupt(uint8_t input)
 {
+   capture_edge(input);
+   measure_edge(input);
+   input_edge(input);
+   
    uint8_t previous = app_regs.REG_IN_STATE;
    app_read_REG_IN_STATE();
    
    if (previous != app_regs.REG_IN_STATE)
-      if (app_regs.REG_EVNT_ENABLE & B_EVT_IN_STATE)
-         core_func_send_event(ADD_REG_IN_STATE, true);
+      if (!(app_regs.REG_IN_CAPTURE & (input ? B_IN1_CAPTURE : B_IN0_CAPTURE)))
+         input_event(input);
+   
+   input_holdoff(input);
+}
+
+/************************************************************************/ 
+/* IN0                                                                  */
+/************************************************************************/
+ISR(PORTD_INT0_vect, ISR_NAKED)
+{
+   input_interrupt(0);
    
 	reti();
 }
@@ -46,12 +67,7 @@ ISR(PORTD_INT0_vect, ISR_NAKED)
 /************************************************************************/
 ISR(PORTD_INT1_vect, ISR_NAKED)
 {
-   uint8_t previous = app_regs.REG_IN_STATE;
-   app_read_REG_IN_STATE();
-   
-   if (previous != app_regs.REG_IN_STATE)
-      if (app_regs.REG_EVNT_ENABLE & B_EVT_IN_STATE)
-      core_func_send_event(ADD_REG_IN_STATE, true);
+   input_interrupt(1);
    
    reti();
 }